@@ -0,0 +1,323 @@
+// Реализация C ABI (checkers.h) поверх Logic. Исключения C++ не выходят за границу библиотеки:
+// каждая функция ловит их и возвращает код ошибки, текст сохраняется в thread_local строке.
+#include "checkers.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Engine/Batch_eval.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+
+using namespace std;
+
+// маски позиции 8 x 8 читаются без копирования как packed_position
+static_assert(sizeof(checkers_packed) == sizeof(packed_position), "checkers_packed must match bit_position<8>");
+static_assert(sizeof(checkers_step) == 6, "checkers_step must stay 6 bytes");
+
+struct checkers_engine
+{
+    mutex lock;
+    int size = 8;
+    unique_ptr<Logic> logic;
+    eval_weights weights;
+    bool nnue = false;
+};
+
+namespace
+{
+thread_local string last_error;
+
+// Ошибка с кодом для вызывающего
+struct api_error : runtime_error
+{
+    int code;
+    api_error(const int code, const string &what) : runtime_error(what), code(code)
+    {
+    }
+};
+
+void require(const bool condition, const char *what)
+{
+    if (!condition)
+        throw api_error(CHECKERS_ERROR_ARGUMENT, what);
+}
+
+// Выполняет f, переводя исключения в код ошибки
+template <class F> int guarded(F &&f)
+{
+    try
+    {
+        last_error.clear();
+        return f();
+    }
+    catch (const api_error &e)
+    {
+        last_error = e.what();
+        return e.code;
+    }
+    catch (const bad_alloc &)
+    {
+        last_error = "out of memory";
+        return CHECKERS_ERROR_INTERNAL;
+    }
+    catch (const exception &e)
+    {
+        last_error = e.what();
+        return CHECKERS_ERROR_INTERNAL;
+    }
+}
+
+vector<vector<POS_T>> board_to_mtx(const int8_t *board, const int size)
+{
+    require(board, "board is NULL");
+    vector<vector<POS_T>> mtx(size, vector<POS_T>(size, 0));
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = 0; j < size; ++j)
+        {
+            const int8_t type = board[i * size + j];
+            require(type >= 0 && type <= 4, "board values must be 0..4");
+            mtx[i][j] = type;
+        }
+    }
+    return mtx;
+}
+
+void mtx_to_board(const vector<vector<POS_T>> &mtx, int8_t *board)
+{
+    const size_t size = mtx.size();
+    for (size_t i = 0; i < size; ++i)
+        for (size_t j = 0; j < size; ++j)
+            board[i * size + j] = int8_t(mtx[i][j]);
+}
+
+void to_c_move(const vector<move_pos> &turns, checkers_move &move)
+{
+    if (turns.size() > CHECKERS_MAX_STEPS)
+        throw api_error(CHECKERS_ERROR_INTERNAL, "move is longer than CHECKERS_MAX_STEPS");
+    move.step_count = int32_t(turns.size());
+    for (size_t k = 0; k < turns.size(); ++k)
+        move.steps[k] = checkers_step{int8_t(turns[k].x),  int8_t(turns[k].y),  int8_t(turns[k].x2),
+                                      int8_t(turns[k].y2), int8_t(turns[k].xb), int8_t(turns[k].yb)};
+}
+
+bool same_move(const vector<move_pos> &turns, const checkers_move &move)
+{
+    if (int32_t(turns.size()) != move.step_count)
+        return false;
+    for (size_t k = 0; k < turns.size(); ++k)
+    {
+        const checkers_step &s = move.steps[k];
+        if (turns[k].x != s.x || turns[k].y != s.y || turns[k].x2 != s.x2 || turns[k].y2 != s.y2 ||
+            turns[k].xb != s.xb || turns[k].yb != s.yb)
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+extern "C"
+{
+    CHECKERS_API int checkers_api_version(void)
+    {
+        return CHECKERS_API_VERSION;
+    }
+
+    CHECKERS_API const char *checkers_last_error(void)
+    {
+        return last_error.c_str();
+    }
+
+    CHECKERS_API void checkers_config_init(checkers_config *config)
+    {
+        if (!config)
+            return;
+        config->size = 8;
+        config->rules = "Russian";
+        config->scoring = "NumberAndPotential";
+        config->optimization = "O1";
+        config->weights_path = nullptr;
+        config->nnue_path = nullptr;
+        config->tt_size_mb = 16;
+    }
+
+    CHECKERS_API checkers_engine *checkers_engine_create(const checkers_config *config)
+    {
+        checkers_engine *res = nullptr;
+        guarded([&]() {
+            require(config, "config is NULL");
+            require(config->size == 8 || config->size == 10, "size must be 8 or 10");
+            logic_settings settings;
+            settings.no_random = true;
+            if (config->rules)
+                settings.rules = config->rules;
+            if (config->scoring)
+                settings.scoring_mode = config->scoring;
+            if (config->optimization)
+                settings.optimization = config->optimization;
+            if (config->weights_path)
+                settings.weights_path = config->weights_path;
+            if (config->nnue_path)
+                settings.nnue_path = config->nnue_path;
+            settings.tt_size_mb = config->tt_size_mb;
+
+            auto engine = make_unique<checkers_engine>();
+            engine->size = config->size;
+            try
+            {
+                engine->logic = config->size == 10 ? make_logic<10>(settings) : make_logic<8>(settings);
+            }
+            catch (const bad_alloc &)
+            {
+                throw;
+            }
+            catch (const exception &e)
+            {
+                throw api_error(CHECKERS_ERROR_SETTINGS, e.what());
+            }
+            // веса для пакетной оценки те же, что у логики (см. BoardLogic)
+            engine->weights = eval_weights::preset(settings.scoring_mode);
+            if (!settings.weights_path.empty())
+                engine->weights.load(settings.weights_path);
+            engine->nnue = settings.scoring_mode == "NNUE";
+            res = engine.release();
+            return CHECKERS_OK;
+        });
+        return res;
+    }
+
+    CHECKERS_API void checkers_engine_destroy(checkers_engine *engine)
+    {
+        delete engine;
+    }
+
+    CHECKERS_API int checkers_engine_clear(checkers_engine *engine)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            lock_guard<mutex> guard(engine->lock);
+            engine->logic->new_game();
+            engine->logic->clear_cache();
+            return CHECKERS_OK;
+        });
+    }
+
+    CHECKERS_API int checkers_start_position(int32_t size, int8_t *board)
+    {
+        return guarded([&]() {
+            require(size == 8 || size == 10, "size must be 8 or 10");
+            require(board, "board is NULL");
+            mtx_to_board(start_mtx(size), board);
+            return CHECKERS_OK;
+        });
+    }
+
+    CHECKERS_API int checkers_pack(const int8_t *board, checkers_packed *packed)
+    {
+        return guarded([&]() {
+            require(packed, "packed is NULL");
+            const packed_position pos = pack_position(board_to_mtx(board, 8));
+            memcpy(packed, &pos, sizeof(pos));
+            return CHECKERS_OK;
+        });
+    }
+
+    CHECKERS_API int checkers_legal_moves(checkers_engine *engine, const int8_t *board, int32_t color,
+                                          checkers_move *moves, int32_t capacity)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            require(moves || capacity <= 0, "moves is NULL");
+            lock_guard<mutex> guard(engine->lock);
+            const auto all = engine->logic->find_all_turns(color != 0, board_to_mtx(board, engine->size));
+            for (int32_t k = 0; k < capacity && k < int32_t(all.size()); ++k)
+                to_c_move(all[k], moves[k]);
+            return int(all.size());
+        });
+    }
+
+    CHECKERS_API int checkers_apply_move(checkers_engine *engine, int8_t *board, int32_t color,
+                                         const checkers_move *move)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            require(move, "move is NULL");
+            lock_guard<mutex> guard(engine->lock);
+            auto mtx = board_to_mtx(board, engine->size);
+            for (const auto &turns : engine->logic->find_all_turns(color != 0, mtx))
+            {
+                if (!same_move(turns, *move))
+                    continue;
+                for (const auto &turn : turns)
+                    mtx = engine->logic->make_turn(mtx, turn);
+                mtx_to_board(mtx, board);
+                return CHECKERS_OK;
+            }
+            throw api_error(CHECKERS_ERROR_ARGUMENT, "move is not legal in this position");
+        });
+    }
+
+    CHECKERS_API int checkers_search(checkers_engine *engine, const int8_t *board, int32_t color,
+                                     const checkers_limits *limits, checkers_line *lines, int32_t capacity,
+                                     uint64_t *nodes)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            require(limits, "limits is NULL");
+            require(lines && capacity > 0, "lines must hold at least one line");
+            require(limits->level >= 0, "level must not be negative");
+            lock_guard<mutex> guard(engine->lock);
+            const auto found = find_best_lines_limited(*engine->logic, color != 0, board_to_mtx(board, engine->size),
+                                                       size_t(capacity), limits->level, limits->time_ms);
+            if (nodes)
+                *nodes = engine->logic->nodes;
+            for (size_t k = 0; k < found.size(); ++k)
+            {
+                to_c_move(found[k].turns, lines[k].move);
+                lines[k].score = found[k].score;
+                lines[k].depth = found[k].depth;
+            }
+            return int(found.size());
+        });
+    }
+
+    CHECKERS_API int checkers_evaluate(checkers_engine *engine, const int8_t *boards, size_t count, int32_t *scores)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            require((boards && scores) || count == 0, "boards or scores is NULL");
+            lock_guard<mutex> guard(engine->lock);
+            const size_t cells = size_t(engine->size) * engine->size;
+            for (size_t k = 0; k < count; ++k)
+                scores[k] = engine->logic->calc_score(board_to_mtx(boards + k * cells, engine->size), 0);
+            return CHECKERS_OK;
+        });
+    }
+
+    CHECKERS_API int checkers_evaluate_packed(checkers_engine *engine, const checkers_packed *positions, size_t count,
+                                              int32_t *scores, uint32_t threads)
+    {
+        return guarded([&]() {
+            require(engine, "engine is NULL");
+            require(engine->size == 8, "packed positions are 8x8 only");
+            require((positions && scores) || count == 0, "positions or scores is NULL");
+            lock_guard<mutex> guard(engine->lock);
+            const auto *packed = reinterpret_cast<const packed_position *>(positions);
+            if (engine->nnue)
+            {
+                for (size_t k = 0; k < count; ++k)
+                    scores[k] = engine->logic->calc_score(unpack_position(packed[k]), 0);
+                return CHECKERS_OK;
+            }
+            evaluate_batch_parallel(engine->weights, packed, count, scores,
+                                    threads ? threads : thread::hardware_concurrency());
+            return CHECKERS_OK;
+        });
+    }
+}
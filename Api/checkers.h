@@ -0,0 +1,138 @@
+/* C ABI движка шашек (библиотека checkers_api): без SDL, json и типов C++ в интерфейсе.
+ * Доска - массив size * size значений int8_t по строкам: 0 - пусто, 1/2 - белая/черная шашка, 3/4 - белая/черная дамка;
+ * строка 0 - сторона черных, белые шашки ходят к строке 0. Сторона: 0 - белые, 1 - черные.
+ * Все массивы (доски, ходы, оценки) выделяет вызывающий, библиотека только читает и заполняет их.
+ * Движки независимы: разные потоки могут одновременно работать каждый со своим движком; вызовы одного движка
+ * из нескольких потоков выполняются по очереди. Функции возвращают CHECKERS_OK (или число элементов) либо
+ * отрицательный код ошибки, текст последней ошибки потока - checkers_last_error. */
+#ifndef CHECKERS_API_H
+#define CHECKERS_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(CHECKERS_API_BUILD)
+#define CHECKERS_API __declspec(dllexport)
+#else
+#define CHECKERS_API __declspec(dllimport)
+#endif
+#else
+#define CHECKERS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Версия интерфейса: меняется, если меняются структуры или смысл функций */
+#define CHECKERS_API_VERSION 1
+/* Наибольшее число шагов в одном ходе (серия взятий): на доске 10 x 10 у соперника не больше 20 фигур */
+#define CHECKERS_MAX_STEPS 20
+
+enum
+{
+    CHECKERS_OK = 0,
+    CHECKERS_ERROR_ARGUMENT = -1, /* неверный аргумент: нулевой указатель, размер доски, ход не по правилам */
+    CHECKERS_ERROR_SETTINGS = -2, /* неверные настройки движка: правила, файл весов или сети */
+    CHECKERS_ERROR_INTERNAL = -3  /* нехватка памяти и прочие ошибки */
+};
+
+typedef struct checkers_engine checkers_engine;
+
+/* Один шаг хода: откуда (x, y), куда (x2, y2) и взятая фигура (xb, yb), -1 - без взятия */
+typedef struct
+{
+    int8_t x, y, x2, y2, xb, yb;
+} checkers_step;
+
+/* Ход целиком: тихий ход - один шаг, серия взятий - несколько */
+typedef struct
+{
+    int32_t step_count;
+    checkers_step steps[CHECKERS_MAX_STEPS];
+} checkers_move;
+
+/* Позиция 8 x 8 масками: клетка (i, j) - бит i * 4 + j / 2; индекс массива - сторона */
+typedef struct
+{
+    uint32_t men[2];
+    uint32_t kings[2];
+} checkers_packed;
+
+typedef struct
+{
+    int32_t size;             /* 8 или 10 */
+    const char *rules;        /* "Russian", "English" или "Brazilian" */
+    const char *scoring;      /* "NumberOnly", "NumberAndPotential" или "NNUE" (только 8 x 8) */
+    const char *optimization; /* "O0", "O1" или "O2" */
+    const char *weights_path; /* файл весов оценки, NULL или "" - веса по scoring */
+    const char *nnue_path;    /* файл сети для scoring "NNUE" */
+    uint32_t tt_size_mb;      /* размер таблицы транспозиций в мегабайтах */
+} checkers_config;
+
+/* Ограничения поиска */
+typedef struct
+{
+    int32_t level;   /* уровень поиска (глубина), как уровень бота */
+    int32_t time_ms; /* больше 0 - уровни растут с 0, пока не пройдет time_ms (не выше level) */
+} checkers_limits;
+
+/* Вариант поиска: ход, оценка с точки зрения ходящего (1000 - единица логарифма отношения сил,
+ * по модулю больше 990000 - доказанный выигрыш или проигрыш) и уровень, на котором она получена */
+typedef struct
+{
+    checkers_move move;
+    int32_t score;
+    int32_t depth;
+} checkers_line;
+
+CHECKERS_API int checkers_api_version(void);
+
+/* Текст последней ошибки в этом потоке, "" - ошибок не было */
+CHECKERS_API const char *checkers_last_error(void);
+
+/* Заполняет настройки значениями по умолчанию: 8 x 8, русские шашки, NumberAndPotential, O1, 16 МБ */
+CHECKERS_API void checkers_config_init(checkers_config *config);
+
+/* Новый движок или NULL (причина - checkers_last_error). Поиск движка детерминирован */
+CHECKERS_API checkers_engine *checkers_engine_create(const checkers_config *config);
+CHECKERS_API void checkers_engine_destroy(checkers_engine *engine);
+
+/* Забывает результаты прошлых поисков (таблицу транспозиций) */
+CHECKERS_API int checkers_engine_clear(checkers_engine *engine);
+
+/* Начальная расстановка в board (size * size значений) */
+CHECKERS_API int checkers_start_position(int32_t size, int8_t *board);
+
+/* Позиция 8 x 8 в виде масок */
+CHECKERS_API int checkers_pack(const int8_t *board, checkers_packed *packed);
+
+/* Все ходы стороны color. В moves пишется не больше capacity ходов, результат - общее число ходов
+ * (если он больше capacity, нужен массив больше) */
+CHECKERS_API int checkers_legal_moves(checkers_engine *engine, const int8_t *board, int32_t color,
+                                      checkers_move *moves, int32_t capacity);
+
+/* Делает ход на доске board, ход должен быть разрешен правилами */
+CHECKERS_API int checkers_apply_move(checkers_engine *engine, int8_t *board, int32_t color,
+                                     const checkers_move *move);
+
+/* Поиск: capacity лучших ходов по убыванию оценки (мульти-PV), результат - число записанных вариантов
+ * (0 - ходов нет). nodes (может быть NULL) - число узлов поиска */
+CHECKERS_API int checkers_search(checkers_engine *engine, const int8_t *board, int32_t color,
+                                 const checkers_limits *limits, checkers_line *lines, int32_t capacity,
+                                 uint64_t *nodes);
+
+/* Статическая оценка count досок (подряд по size * size значений) с точки зрения белых */
+CHECKERS_API int checkers_evaluate(checkers_engine *engine, const int8_t *boards, size_t count, int32_t *scores);
+
+/* То же для позиций 8 x 8 в масках без распаковки, на threads потоках (0 - по числу ядер).
+ * Для весовой оценки считается блоками по маскам, для NNUE - по одной позиции */
+CHECKERS_API int checkers_evaluate_packed(checkers_engine *engine, const checkers_packed *positions, size_t count,
+                                          int32_t *scores, uint32_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Pn_search.h"
+#include "Position_history.h"
+
+using namespace std;
+
+// Досрочное завершение партий бот против бота (checkers_cli, checkers_selfplay). Каждое правило выключается нулем.
+struct adjudication_settings
+{
+    int win_score = 0;          // победа: оценки ходов не меньше win_score в пользу одной стороны ...
+    int win_turns = 8;          // ... win_turns ходов подряд (поиск обеих сторон согласен)
+    int draw_score = 0;         // ничья: оценки ходов не больше draw_score по модулю ...
+    int draw_turns = 16;        // ... draw_turns ходов подряд ...
+    int draw_after = 40;        // ... начиная с хода draw_after
+    int king_draw_turns = 0;    // ничья: king_draw_turns ходов ходят только дамки и никто не бьет
+    int repetition = 0;         // ничья: позиция повторилась столько раз
+    int solver_pieces = 0;      // точный результат решателем (Pn_search.h), когда фигур не больше solver_pieces
+    uint64_t solver_nodes = 20000; // узлов решателя на одну расстановку (около 1 мкс на узел)
+
+    // Настройки --adjudicate
+    static adjudication_settings defaults()
+    {
+        adjudication_settings s;
+        s.win_score = 1500;
+        s.draw_score = 50;
+        s.king_draw_turns = 15;
+        s.repetition = 3;
+        s.solver_pieces = 4;
+        return s;
+    }
+
+    bool enabled() const
+    {
+        return win_score > 0 || draw_score > 0 || king_draw_turns > 0 || repetition > 0 || solver_pieces > 0;
+    }
+};
+
+// Следит за партией по ходам и решает, закончить ли ее. Результат - как у Game::play:
+// 0 - ничья, 1 - победа белых, 2 - победа черных; reason() - правило, по которому партия закончена
+template <int N = 8> class Adjudicator
+{
+  public:
+    // Оценка хода неизвестна (случайный ход, ход человека)
+    static constexpr int NO_SCORE = INT32_MIN;
+
+    Adjudicator(const adjudication_settings &settings, const string &rules, const int max_turns)
+        : settings(settings), rules(rules), max_turns(max_turns),
+          history(settings.repetition, settings.king_draw_turns)
+    {
+    }
+
+    void new_game()
+    {
+        streak = 0;
+        streak_side = 0;
+        draw_streak = 0;
+        solved_pieces = -1;
+        history.clear();
+        why.clear();
+    }
+
+    // Вызывается после хода turn_num стороны color; mtx - позиция после хода, score - оценка хода поиском
+    // с точки зрения color или NO_SCORE. -1 - партия продолжается
+    int after_turn(const vector<vector<POS_T>> &mtx, const bool color, const int score, const int turn_num)
+    {
+        int pieces = 0;
+        for (const auto &row : mtx)
+            for (const POS_T c : row)
+                pieces += c != 0;
+
+        if (settings.win_score > 0)
+        {
+            // сторона, которую оценка считает выигрывающей: 1 - белые, 2 - черные
+            int side = 0;
+            if (score != NO_SCORE && abs(score) >= settings.win_score)
+                side = (score > 0) == !color ? 1 : 2;
+            streak = side && side == streak_side ? streak + 1 : side ? 1 : 0;
+            streak_side = side;
+            if (streak >= settings.win_turns)
+                return finish(side, "win_score");
+        }
+
+        if (settings.draw_score > 0)
+        {
+            const bool level = score != NO_SCORE && abs(score) <= settings.draw_score && turn_num >= settings.draw_after;
+            draw_streak = level ? draw_streak + 1 : 0;
+            if (draw_streak >= settings.draw_turns)
+                return finish(0, "draw_score");
+        }
+
+        // повторение и ходы одними дамками - по позициям с последнего необратимого хода
+        history.push(mtx, !color);
+        const string draw = history.draw();
+        if (!draw.empty())
+            return finish(0, draw == "repetition" ? "repetition" : "kings");
+
+        // решатель запускается один раз на каждое число фигур
+        if (settings.solver_pieces > 0 && pieces <= settings.solver_pieces && pieces != solved_pieces)
+        {
+            solved_pieces = pieces;
+            const int value = solve(mtx, !color, max_turns - turn_num - 1);
+            if (value == PN_WIN)
+                return finish(color ? 1 : 2, "solver");
+            if (value == PN_LOSS)
+                return finish(color ? 2 : 1, "solver");
+            if (value == PN_DRAW)
+                return finish(0, "solver");
+        }
+        return -1;
+    }
+
+    // "win_score", "draw_score", "repetition", "kings" или "solver"
+    const string &reason() const
+    {
+        return why;
+    }
+
+  private:
+    int finish(const int result, const char *rule)
+    {
+        why = rule;
+        return result;
+    }
+
+    int solve(const vector<vector<POS_T>> &mtx, const bool color, const int plies) const
+    {
+        if (plies <= 0)
+            return PN_DRAW;
+        pn_settings ps;
+        ps.max_plies = plies;
+        // партию по обратимым ходам заканчивает правило игры или, если оно раньше, king_draw_turns
+        ps.quiet_plies = history.quiet_plies();
+        ps.quiet_limit = quiet_draw_turns(rules);
+        if (settings.king_draw_turns > 0)
+            ps.quiet_limit = min(ps.quiet_limit, settings.king_draw_turns);
+        // таблица на все узлы бюджета с запасом
+        ps.tt_size_mb = max<size_t>(1, size_t(settings.solver_nodes) * sizeof(pn_entry) * 4 >> 20);
+        ps.threads = 1;
+        ps.max_nodes = settings.solver_nodes;
+        return visit_rules(rules, [&](auto r) {
+            pn_solver<N, decltype(r)> solver(ps);
+            return solver.solve(mtx, color).value;
+        });
+    }
+
+    adjudication_settings settings;
+    string rules;
+    int max_turns;
+    int streak = 0, streak_side = 0;
+    int draw_streak = 0;
+    int solved_pieces = -1;
+    position_history history;
+    string why;
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "Logic.h"
+
+using namespace std;
+
+// Пакетная оценка позиций для тюнера, анализа и генерации данных.
+// Позиция хранится масками bit_position<8> (клетка (i, j) - бит i * 4 + j / 2, см. Geometry.h),
+// признаки eval_features считаются popcount по маскам над блоками в виде структуры массивов,
+// результат совпадает с Logic::calc_score(mtx, 0) (оценка с точки зрения белых).
+using packed_position = bit_position<8>;
+
+inline packed_position pack_position(const vector<vector<POS_T>> &mtx)
+{
+    return packed_position::from_mtx(mtx);
+}
+
+inline vector<vector<POS_T>> unpack_position(const packed_position &pos)
+{
+    return pos.to_mtx();
+}
+
+namespace batch_eval
+{
+// Позиции обрабатываются блоками: блок транспонируется в массивы масок и признаков на стеке
+const size_t BLOCK = 256;
+// Кусок работы одного потока в evaluate_batch_parallel
+const size_t CHUNK = 1 << 14;
+
+// Маски признаков для каждой стороны
+struct feature_masks
+{
+    uint32_t advance[2][3]; // биты продвижения шашки: advance = сумма 2^k по маскам, где стоит шашка
+    uint32_t back_rank[2];
+    uint32_t center;
+
+    feature_masks()
+    {
+        for (auto &side : advance)
+            fill(side, side + 3, 0u);
+        back_rank[0] = back_rank[1] = center = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            for (int j = (i + 1) % 2; j < 8; j += 2)
+            {
+                const uint32_t bit = 1u << (i * 4 + j / 2);
+                for (int k = 0; k < 3; ++k)
+                {
+                    if ((7 - i) >> k & 1)
+                        advance[0][k] |= bit;
+                    if (i >> k & 1)
+                        advance[1][k] |= bit;
+                }
+                if (i == 7)
+                    back_rank[0] |= bit;
+                if (i == 0)
+                    back_rank[1] |= bit;
+                if ((i == 3 || i == 4) && j >= 2 && j <= 5)
+                    center |= bit;
+            }
+        }
+    }
+};
+
+inline const feature_masks &masks()
+{
+    static const feature_masks m;
+    return m;
+}
+
+// out[k] = popcount(a[k] & mask) для n значений, n кратно 8
+inline void popcount_masked(const uint32_t *a, const uint32_t mask, int32_t *out, const size_t n)
+{
+#if defined(__AVX2__)
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2,
+                                         2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f), ones8 = _mm256_set1_epi8(1), ones16 = _mm256_set1_epi16(1);
+    const __m256i m = _mm256_set1_epi32(int(mask));
+    for (size_t k = 0; k < n; k += 8)
+    {
+        const __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + k)), m);
+        const __m256i cnt8 = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+                                             _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        // суммы байтов внутри каждого 32-битного слова
+        const __m256i cnt32 = _mm256_madd_epi16(_mm256_maddubs_epi16(cnt8, ones8), ones16);
+        _mm256_storeu_si256((__m256i *)(out + k), cnt32);
+    }
+#elif defined(__POPCNT__)
+    for (size_t k = 0; k < n; ++k)
+        out[k] = __builtin_popcount(a[k] & mask);
+#else
+    // без инструкции popcnt: побитовый подсчет, который компилятор векторизует на SSE2
+    for (size_t k = 0; k < n; ++k)
+    {
+        uint32_t x = a[k] & mask;
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+        out[k] = int32_t((x * 0x01010101u) >> 24);
+    }
+#endif
+}
+
+// Блок позиций в виде структуры массивов
+struct block
+{
+    alignas(32) uint32_t men[2][BLOCK];
+    alignas(32) uint32_t kings[2][BLOCK];
+    alignas(32) uint32_t pieces[2][BLOCK];
+    alignas(32) int32_t tmp[BLOCK];
+    // признаки eval_features по сторонам
+    alignas(32) int32_t men_count[2][BLOCK];
+    alignas(32) int32_t king_count[2][BLOCK];
+    alignas(32) int32_t advance[2][BLOCK];
+    alignas(32) int32_t center[2][BLOCK];
+    alignas(32) int32_t back_rank[2][BLOCK];
+    alignas(32) double material[2][BLOCK];
+};
+
+// Оценка блока из n <= BLOCK позиций
+inline void evaluate_block(const eval_weights &weights, const packed_position *positions, const size_t n, int *scores,
+                           block &b)
+{
+    const size_t padded = (n + 7) / 8 * 8;
+    for (size_t k = 0; k < padded; ++k)
+    {
+        const packed_position pos = k < n ? positions[k] : packed_position{{0, 0}, {0, 0}};
+        for (int c = 0; c < 2; ++c)
+        {
+            b.men[c][k] = pos.men[c];
+            b.kings[c][k] = pos.kings[c];
+            b.pieces[c][k] = pos.men[c] | pos.kings[c];
+        }
+    }
+
+    const feature_masks &m = masks();
+    for (int c = 0; c < 2; ++c)
+    {
+        popcount_masked(b.men[c], ~0u, b.men_count[c], padded);
+        popcount_masked(b.kings[c], ~0u, b.king_count[c], padded);
+        popcount_masked(b.pieces[c], m.center, b.center[c], padded);
+        popcount_masked(b.men[c], m.back_rank[c], b.back_rank[c], padded);
+        popcount_masked(b.men[c], m.advance[c][0], b.advance[c], padded);
+        for (int bit = 1; bit < 3; ++bit)
+        {
+            popcount_masked(b.men[c], m.advance[c][bit], b.tmp, padded);
+            for (size_t k = 0; k < padded; ++k)
+                b.advance[c][k] += b.tmp[k] << bit;
+        }
+        // тот же порядок сложения, что в eval_weights::material, чтобы округление совпадало с calc_score
+        for (size_t k = 0; k < padded; ++k)
+            b.material[c][k] = weights.man * b.men_count[c][k] + weights.king * b.king_count[c][k] +
+                               weights.advance * b.advance[c][k] + weights.center * b.center[c][k] +
+                               weights.back_rank * b.back_rank[c][k];
+    }
+
+    // логарифм отношения сторон, как в Logic::calc_score
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (b.men_count[0][k] + b.king_count[0][k] == 0)
+            scores[k] = -WIN_SCORE;
+        else if (b.men_count[1][k] + b.king_count[1][k] == 0)
+            scores[k] = WIN_SCORE;
+        else
+            scores[k] = int(lround(SCORE_SCALE * log(max(b.material[0][k], 1e-3) / max(b.material[1][k], 1e-3))));
+    }
+}
+} // namespace batch_eval
+
+// Оценка count позиций в одном потоке, scores[k] - оценка positions[k] с точки зрения белых
+inline void evaluate_batch(const eval_weights &weights, const packed_position *positions, const size_t count,
+                           int *scores)
+{
+    batch_eval::block b;
+    for (size_t start = 0; start < count; start += batch_eval::BLOCK)
+        batch_eval::evaluate_block(weights, positions + start, min(batch_eval::BLOCK, count - start), scores + start,
+                                   b);
+}
+
+// То же на threads потоках: потоки берут куски по batch_eval::CHUNK позиций, пока они не кончатся
+inline void evaluate_batch_parallel(const eval_weights &weights, const packed_position *positions, const size_t count,
+                                    int *scores, unsigned threads = thread::hardware_concurrency())
+{
+    const size_t chunks = (count + batch_eval::CHUNK - 1) / batch_eval::CHUNK;
+    threads = unsigned(min<size_t>(max(threads, 1u), chunks));
+    if (threads <= 1)
+    {
+        evaluate_batch(weights, positions, count, scores);
+        return;
+    }
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t chunk = next++; chunk < chunks; chunk = next++)
+        {
+            const size_t start = chunk * batch_eval::CHUNK;
+            evaluate_batch(weights, positions + start, min(batch_eval::CHUNK, count - start), scores + start);
+        }
+    };
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back(worker);
+    for (auto &th : workers)
+        th.join();
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Geometry.h"
+
+using namespace std;
+
+// Позиция в виде масок: шашки и дамки каждой стороны (0 - белые, 1 - черные).
+// Матрица vector<vector<POS_T>> остается форматом обмена с GUI и инструментами, поиск работает с масками.
+template <int N> struct bit_position
+{
+    using geo = board_geometry<N>;
+    using mask_t = typename geo::mask_t;
+
+    mask_t men[2] = {0, 0};
+    mask_t kings[2] = {0, 0};
+
+    mask_t pieces(const bool color) const
+    {
+        return men[color] | kings[color];
+    }
+
+    mask_t occupied() const
+    {
+        return men[0] | men[1] | kings[0] | kings[1];
+    }
+
+    // Тип фигуры на клетке s в кодировке матрицы: 0 - пусто, 1/2 - белая/черная шашка, 3/4 - белая/черная дамка
+    POS_T type_at(const int s) const
+    {
+        const mask_t bit = mask_t(1) << s;
+        if (men[0] & bit)
+            return 1;
+        if (men[1] & bit)
+            return 2;
+        if (kings[0] & bit)
+            return 3;
+        if (kings[1] & bit)
+            return 4;
+        return 0;
+    }
+
+    static bit_position from_mtx(const vector<vector<POS_T>> &mtx)
+    {
+        bit_position pos;
+        for (int i = 0; i < N; ++i)
+        {
+            for (int j = (i + 1) % 2; j < N; j += 2)
+            {
+                const POS_T type = mtx[i][j];
+                if (!type)
+                    continue;
+                const mask_t bit = mask_t(1) << geo::square(i, j);
+                (type > 2 ? pos.kings : pos.men)[type % 2 == 0] |= bit;
+            }
+        }
+        return pos;
+    }
+
+    vector<vector<POS_T>> to_mtx() const
+    {
+        vector<vector<POS_T>> mtx(N, vector<POS_T>(N, 0));
+        for (int s = 0; s < geo::SQUARES; ++s)
+            mtx[geo::row(s)][geo::col(s)] = type_at(s);
+        return mtx;
+    }
+
+    // Снимает фигуру с клетки s
+    void remove(const int s)
+    {
+        const mask_t keep = ~(mask_t(1) << s);
+        men[0] &= keep;
+        men[1] &= keep;
+        kings[0] &= keep;
+        kings[1] &= keep;
+    }
+
+    // Дамка на клетке s снова становится шашкой (для правил, где превращение откладывается, см. movegen::apply)
+    void demote(const int s)
+    {
+        const mask_t bit = mask_t(1) << s;
+        for (int c = 0; c < 2; ++c)
+        {
+            if (kings[c] & bit)
+            {
+                kings[c] ^= bit;
+                men[c] |= bit;
+            }
+        }
+    }
+
+    // Один шаг хода по русским правилам, как Logic::make_turn: взятая фигура снимается сразу, шашка на последней строке становится дамкой
+    void apply(const move_pos &turn)
+    {
+        const mask_t from = mask_t(1) << geo::square(turn.x, turn.y);
+        const mask_t to = mask_t(1) << geo::square(turn.x2, turn.y2);
+        if (turn.xb != -1)
+            remove(geo::square(turn.xb, turn.yb));
+        const bool color = !(pieces(0) & from);
+        if (kings[color] & from)
+        {
+            kings[color] ^= from | to;
+            return;
+        }
+        men[color] ^= from;
+        if (to & geometry<N>().promotion[color])
+            kings[color] |= to;
+        else
+            men[color] |= to;
+    }
+
+    bool operator==(const bit_position &other) const
+    {
+        return men[0] == other.men[0] && men[1] == other.men[1] && kings[0] == other.kings[0] &&
+               kings[1] == other.kings[1];
+    }
+};
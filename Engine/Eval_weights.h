@@ -0,0 +1,143 @@
+#pragma once
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+// Признаки позиции для одной стороны, из которых складывается оценка Logic::calc_score
+struct eval_features
+{
+    double men = 0;       // количество шашек
+    double kings = 0;     // количество дамок
+    double advance = 0;   // сумма продвижения шашек (в строках от своего края)
+    double center = 0;    // фигуры в центре (строки 3-4, столбцы 2-5)
+    double back_rank = 0; // шашки, оставшиеся на своей последней линии
+};
+
+// Считает признаки белых (w) и черных (b) за один проход по доске
+inline void extract_features(const vector<vector<POS_T>> &mtx, eval_features &w, eval_features &b)
+{
+    w = eval_features();
+    b = eval_features();
+    const POS_T n = POS_T(mtx.size());
+    for (POS_T i = 0; i < n; ++i)
+    {
+        for (POS_T j = (i + 1) % 2; j < n; j += 2)
+        {
+            const POS_T type = mtx[i][j];
+            if (!type)
+                continue;
+            eval_features &f = (type % 2 ? w : b);
+            const bool is_center = (i == n / 2 - 1 || i == n / 2) && j >= 2 && j <= n - 3;
+            f.center += is_center;
+            if (type > 2)
+            {
+                f.kings += 1;
+                continue;
+            }
+            f.men += 1;
+            f.advance += (type == 1 ? n - 1 - i : i);
+            f.back_rank += (type == 1 ? i == n - 1 : i == 0);
+        }
+    }
+}
+
+// То же по маскам позиции: каждый признак - popcount маски фигур с маской клеток из geometry_tables
+template <int N> void extract_features(const bit_position<N> &pos, eval_features &w, eval_features &b)
+{
+    const auto &g = geometry<N>();
+    for (int c = 0; c < 2; ++c)
+    {
+        eval_features &f = c ? b : w;
+        f.men = bit_count(pos.men[c]);
+        f.kings = bit_count(pos.kings[c]);
+        int advance = 0;
+        for (int k = 0; k < 4; ++k)
+            advance += bit_count(pos.men[c] & g.advance[c][k]) << k;
+        f.advance = advance;
+        f.center = bit_count(pos.pieces(c) & g.center);
+        f.back_rank = bit_count(pos.men[c] & g.promotion[!c]);
+    }
+}
+
+// Веса оценки. Оценка стороны - линейная комбинация признаков, Logic::calc_score возвращает отношение оценок сторон.
+struct eval_weights
+{
+    double man = 1;
+    double king = 5;
+    double advance = 0.05;
+    double center = 0;
+    double back_rank = 0;
+
+    double material(const eval_features &f) const
+    {
+        return man * f.men + king * f.kings + advance * f.advance + center * f.center + back_rank * f.back_rank;
+    }
+
+    // Встроенные веса для BotScoringType: NumberOnly учитывает только количество фигур
+    static eval_weights preset(const string &scoring_mode)
+    {
+        eval_weights res;
+        if (scoring_mode == "NumberOnly")
+        {
+            res.king = 4;
+            res.advance = 0;
+        }
+        return res;
+    }
+
+    // Файл весов: строки "имя значение", строки с '#' - комментарии
+    bool load(const string &path)
+    {
+        ifstream fin(path);
+        if (!fin)
+            return false;
+        string line;
+        while (getline(fin, line))
+        {
+            istringstream in(line);
+            string name;
+            double value;
+            if (!(in >> name) || name[0] == '#' || !(in >> value))
+                continue;
+            if (double *w = find(name))
+                *w = value;
+        }
+        return true;
+    }
+
+    bool save(const string &path) const
+    {
+        ofstream fout(path);
+        fout.precision(8);
+        fout << "# checkers evaluation weights\n";
+        fout << "man " << man << "\nking " << king << "\nadvance " << advance << "\ncenter " << center
+             << "\nback_rank " << back_rank << "\n";
+        return bool(fout);
+    }
+
+    static vector<string> names()
+    {
+        return {"man", "king", "advance", "center", "back_rank"};
+    }
+
+    double *find(const string &name)
+    {
+        if (name == "man")
+            return &man;
+        if (name == "king")
+            return &king;
+        if (name == "advance")
+            return &advance;
+        if (name == "center")
+            return &center;
+        if (name == "back_rank")
+            return &back_rank;
+        return nullptr;
+    }
+};
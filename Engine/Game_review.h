@@ -0,0 +1,244 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logic.h"
+#include "Position.h"
+
+using namespace std;
+
+// Разбор сыгранной партии: каждая позиция ищется заново (мульти-PV по всем ходам корня), сыгранный ход сравнивается
+// с лучшим, и в отчет попадают ходы с наибольшей потерей оценки. Позиции независимы, поэтому их разбирают
+// несколько потоков, у каждого своя логика и своя таблица транспозиций.
+
+// Партия как последовательность досок: record[i] - доска перед ходом i (при четном i ходят белые),
+// последняя доска - после последнего хода
+using game_record = vector<vector<vector<POS_T>>>;
+
+struct review_settings
+{
+    int level = 6;        // уровень поиска (Max_depth) в каждой позиции
+    int time_ms = 0;      // больше 0 - уровни перебираются с 0, пока на позицию не уйдет time_ms (но не выше level)
+    unsigned threads = 0; // 0 - по числу ядер
+    size_t top = 3;       // сколько худших ходов партии попадает в отчет
+};
+
+// Разбор одного хода партии; оценки с точки зрения ходившей стороны
+struct move_review
+{
+    int turn_num = 0;       // номер хода с 0
+    vector<move_pos> played;
+    vector<move_pos> best;
+    int played_score = 0;
+    int best_score = 0;
+    int depth = 0;          // уровень, на котором получены оценки
+
+    int loss() const
+    {
+        return best_score - played_score;
+    }
+};
+
+// Сыгранный ход i: ход корня, после которого получается record[i + 1]; false, если такого хода нет
+inline bool find_played_line(const Logic &logic, const game_record &record, const size_t i,
+                             const vector<analysis_line> &lines, size_t &played)
+{
+    for (played = 0; played < lines.size(); ++played)
+    {
+        auto mtx = record[i];
+        for (const auto &turn : lines[played].turns)
+            mtx = logic.make_turn(mtx, turn);
+        if (mtx == record[i + 1])
+            return true;
+    }
+    return false;
+}
+
+// Разбирает все ходы всех партий на доске N x N. Позиции партий идут в общую очередь, поэтому короткие партии
+// тоже занимают все потоки. stop (если задан) прерывает разбор между позициями; ходы, до которых
+// не дошли, и ходы, которые не удалось сопоставить с доской, в результат не попадают.
+template <int N = 8>
+vector<vector<move_review>> review_games(const logic_settings &settings, const vector<game_record> &games,
+                                         const review_settings &rs, const atomic<bool> *stop = nullptr)
+{
+    vector<pair<size_t, size_t>> jobs;
+    for (size_t g = 0; g < games.size(); ++g)
+        for (size_t i = 0; i + 1 < games[g].size(); ++i)
+            jobs.emplace_back(g, i);
+
+    // результат по номеру задания, чтобы потоки не делили общий вектор
+    vector<move_review> results(jobs.size());
+    vector<char> done(jobs.size(), 0);
+    atomic<size_t> next{0};
+
+    logic_settings search_settings = settings;
+    search_settings.no_random = true;
+    // разбор сравнивает ходы с точным поиском по уровню, а не со случайными доигрываниями
+    search_settings.engine = "Minimax";
+    // проверяем настройки (файл весов, сеть) до запуска потоков, исключение уходит вызывающему
+    make_logic<N>(search_settings);
+
+    auto worker = [&]() {
+        auto logic = make_logic<N>(search_settings);
+        size_t job;
+        while ((job = next.fetch_add(1)) < jobs.size())
+        {
+            if (stop && stop->load(memory_order_relaxed))
+                break;
+            const auto &record = games[jobs[job].first];
+            const size_t i = jobs[job].second;
+            const bool color = i % 2;
+            const auto lines = find_best_lines_limited(*logic, color, record[i], SIZE_MAX, rs.level, rs.time_ms);
+            size_t played;
+            if (lines.empty() || !find_played_line(*logic, record, i, lines, played))
+                continue;
+
+            auto &res = results[job];
+            res.turn_num = int(i);
+            res.played = lines[played].turns;
+            res.best = lines[0].turns;
+            res.played_score = lines[played].score;
+            // доказанный выигрыш останавливает углубление, и сыгранный ход оценен на мелком уровне:
+            // досчитываем его поиском за соперника на том же уровне
+            if (lines[0].score > WIN_BOUND && lines[played].score <= WIN_BOUND)
+            {
+                // оценка соперника считает ходы от его позиции, для ходившего выигрыш на ход дальше
+                const auto reply = logic->find_best_lines(!color, record[i + 1], 1);
+                if (reply.empty())
+                    res.played_score = WIN_SCORE - 1;
+                else if (reply[0].score < -WIN_BOUND)
+                    res.played_score = -reply[0].score - 1;
+                else
+                    res.played_score = -reply[0].score;
+            }
+            res.best_score = lines[0].score;
+            res.depth = lines[0].depth;
+            done[job] = 1;
+        }
+    };
+
+    const unsigned threads = unsigned(
+        min<size_t>(max(rs.threads ? rs.threads : thread::hardware_concurrency(), 1u), max<size_t>(jobs.size(), 1)));
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+        workers.emplace_back(worker);
+    for (auto &th : workers)
+        th.join();
+
+    vector<vector<move_review>> reviews(games.size());
+    for (size_t job = 0; job < jobs.size(); ++job)
+        if (done[job])
+            reviews[jobs[job].first].push_back(results[job]);
+    return reviews;
+}
+
+template <int N = 8>
+vector<move_review> review_game(const logic_settings &settings, const game_record &record, const review_settings &rs,
+                                const atomic<bool> *stop = nullptr)
+{
+    return review_games<N>(settings, {record}, rs, stop)[0];
+}
+
+// top ходов с наибольшей потерей оценки, по убыванию потери; ходы без потери не попадают
+inline vector<move_review> worst_moves(vector<move_review> reviews, const size_t top)
+{
+    reviews.erase(remove_if(reviews.begin(), reviews.end(), [](const move_review &r) { return r.loss() <= 0; }),
+                  reviews.end());
+    stable_sort(reviews.begin(), reviews.end(),
+                [](const move_review &a, const move_review &b) { return a.loss() > b.loss(); });
+    if (reviews.size() > top)
+        reviews.erase(reviews.begin() + top, reviews.end());
+    return reviews;
+}
+
+// Доски партии по ходам в нотации turns_to_string ("c3-d4", "c3:e5:c7") от начальной расстановки.
+// Каждый шаг должен быть разрешен правилами logic; false - ход не удалось разобрать
+inline bool record_from_moves(Logic &logic, const vector<string> &moves, const int size, game_record &record)
+{
+    record.assign(1, start_mtx(size));
+    for (size_t m = 0; m < moves.size(); ++m)
+    {
+        vector<pair<POS_T, POS_T>> cells;
+        size_t pos = 0;
+        while (pos < moves[m].size())
+        {
+            const size_t end = moves[m].find_first_of("-:", pos);
+            const string name = moves[m].substr(pos, end == string::npos ? string::npos : end - pos);
+            POS_T x, y;
+            if (!cell_from_name(name, size, x, y))
+                return false;
+            cells.emplace_back(x, y);
+            pos = end == string::npos ? moves[m].size() : end + 1;
+        }
+        if (cells.size() < 2)
+            return false;
+
+        auto mtx = record.back();
+        logic.find_turns(m % 2, mtx);
+        for (size_t c = 0; c + 1 < cells.size(); ++c)
+        {
+            if (c)
+                logic.find_turns(cells[c].first, cells[c].second, mtx);
+            const move_pos *step = nullptr;
+            for (const auto &turn : logic.turns)
+                if (turn.x == cells[c].first && turn.y == cells[c].second && turn.x2 == cells[c + 1].first &&
+                    turn.y2 == cells[c + 1].second)
+                    step = &turn;
+            if (!step || (c && !logic.have_beats))
+                return false;
+            mtx = logic.make_turn(mtx, *step);
+        }
+        record.push_back(mtx);
+    }
+    return true;
+}
+
+// Значение поля key из строки JSON журнала (см. Logger::append_json): строка без кавычек или число
+inline string log_field(const string &line, const string &key)
+{
+    const string pattern = "\"" + key + "\":";
+    const size_t pos = line.find(pattern);
+    if (pos == string::npos)
+        return "";
+    size_t begin = pos + pattern.size();
+    if (begin < line.size() && line[begin] == '"')
+        return line.substr(begin + 1, line.find('"', begin + 1) - begin - 1);
+    return line.substr(begin, line.find_first_of(",}", begin) - begin);
+}
+
+// Партии из журнала (CLI --log или журнал GUI): ходы - события bot_turn, player_turn и resumed_turn (ходы партии,
+// восстановленной после перезапуска), событие back отменяет value последних ходов, game_end заканчивает партию. Незаконченная партия в конце файла тоже возвращается.
+inline vector<vector<string>> read_logged_games(const string &path)
+{
+    ifstream fin(path);
+    if (!fin)
+        throw runtime_error("can't open " + path);
+    vector<vector<string>> games(1);
+    string line;
+    while (getline(fin, line))
+    {
+        const string event = log_field(line, "event");
+        if (event == "bot_turn" || event == "player_turn" || event == "resumed_turn")
+        {
+            games.back().push_back(log_field(line, "move"));
+        }
+        else if (event == "back")
+        {
+            const size_t undone = min<size_t>(stoul(log_field(line, "value")), games.back().size());
+            games.back().resize(games.back().size() - undone);
+        }
+        else if (event == "game_end" && !games.back().empty())
+        {
+            games.emplace_back();
+        }
+    }
+    if (games.back().empty())
+        games.pop_back();
+    return games;
+}
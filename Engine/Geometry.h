@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Геометрия доски N x N. Фигуры стоят только на темных клетках ((i + j) % 2 == 1), их N * N / 2;
+// клетка (i, j) имеет номер i * N / 2 + j / 2 и соответствует биту маски.
+// Для 8 x 8 маска 32-битная, для 10 x 10 (международные шашки) - 64-битная; других размеров нет,
+// поэтому каждая доска получает свою полную специализацию без общей обобщенной ветки.
+template <int N> struct board_geometry_base
+{
+    static constexpr int SIZE = N;
+    static constexpr int SQUARES = N * N / 2;
+    static constexpr int ROW_SQUARES = N / 2;
+    // строк с шашками у каждой стороны в начальной расстановке
+    static constexpr int MEN_ROWS = N / 2 - 1;
+
+    static constexpr int square(const int i, const int j)
+    {
+        return i * ROW_SQUARES + j / 2;
+    }
+
+    static constexpr int row(const int s)
+    {
+        return s / ROW_SQUARES;
+    }
+
+    static constexpr int col(const int s)
+    {
+        return s % ROW_SQUARES * 2 + (row(s) % 2 == 0);
+    }
+};
+
+template <int N> struct board_geometry;
+
+template <> struct board_geometry<8> : board_geometry_base<8>
+{
+    using mask_t = uint32_t;
+};
+
+template <> struct board_geometry<10> : board_geometry_base<10>
+{
+    using mask_t = uint64_t;
+};
+
+// Направления по диагонали: 0 - (-1, -1), 1 - (-1, +1), 2 - (+1, -1), 3 - (+1, +1).
+// Строка 0 - сторона черных, белые шашки ходят к строке 0 (направления 0 и 1).
+inline constexpr int dir_di(const int d)
+{
+    return d < 2 ? -1 : 1;
+}
+
+inline constexpr int dir_dj(const int d)
+{
+    return d % 2 ? 1 : -1;
+}
+
+inline int bit_count(const uint32_t x)
+{
+#if defined(_MSC_VER)
+    return int(__popcnt(x));
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+inline int bit_count(const uint64_t x)
+{
+#if defined(_MSC_VER)
+    return int(__popcnt64(x));
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+// Номер младшего установленного бита, x != 0
+inline int lowest_bit(const uint32_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward(&idx, x);
+    return int(idx);
+#else
+    return __builtin_ctz(x);
+#endif
+}
+
+inline int lowest_bit(const uint64_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return int(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Таблицы соседей и масок признаков, считаются один раз при первом обращении
+template <int N> struct geometry_tables
+{
+    using geo = board_geometry<N>;
+    using mask_t = typename geo::mask_t;
+
+    int8_t next[geo::SQUARES][4]; // соседняя клетка по направлению или -1
+    mask_t row_mask[N];
+    mask_t advance[2][4]; // биты продвижения шашки (строк от своего края): advance = сумма 2^k * popcount(men & advance[k])
+    mask_t center;        // две средние строки без двух крайних столбцов с каждой стороны
+    mask_t promotion[2];  // строка превращения: для белых - 0, для черных - N - 1
+    // Шаг всех клеток маски по направлению d сдвигом: номер меняется на step_shift[p][d] для клеток строк
+    // четности p, step_from[p][d] - клетки этих строк, у которых есть сосед по направлению d
+    mask_t step_from[2][4];
+    int step_shift[2][4];
+
+    geometry_tables()
+    {
+        for (auto &r : row_mask)
+            r = 0;
+        for (auto &side : advance)
+            for (auto &m : side)
+                m = 0;
+        center = 0;
+        for (auto &parity : step_from)
+            for (auto &m : parity)
+                m = 0;
+        for (int s = 0; s < geo::SQUARES; ++s)
+        {
+            const int i = geo::row(s), j = geo::col(s);
+            const mask_t bit = mask_t(1) << s;
+            for (int d = 0; d < 4; ++d)
+            {
+                const int i2 = i + dir_di(d), j2 = j + dir_dj(d);
+                next[s][d] = int8_t(i2 < 0 || i2 >= N || j2 < 0 || j2 >= N ? -1 : geo::square(i2, j2));
+                if (next[s][d] >= 0)
+                {
+                    step_from[i % 2][d] |= bit;
+                    step_shift[i % 2][d] = next[s][d] - s;
+                }
+            }
+            row_mask[i] |= bit;
+            for (int k = 0; k < 4; ++k)
+            {
+                if ((N - 1 - i) >> k & 1)
+                    advance[0][k] |= bit;
+                if (i >> k & 1)
+                    advance[1][k] |= bit;
+            }
+            if ((i == N / 2 - 1 || i == N / 2) && j >= 2 && j <= N - 3)
+                center |= bit;
+        }
+        promotion[0] = row_mask[0];
+        promotion[1] = row_mask[N - 1];
+    }
+};
+
+template <int N> inline const geometry_tables<N> &geometry()
+{
+    static const geometry_tables<N> tables;
+    return tables;
+}
+
+// Клетки, куда попадают клетки маски m шагом по направлению d (ушедшие за край доски пропадают)
+template <int N> inline typename board_geometry<N>::mask_t step_mask(const typename board_geometry<N>::mask_t m,
+                                                                     const int d)
+{
+    // направления 0, 1 уменьшают номер клетки, 2, 3 - увеличивают
+    const auto &g = geometry<N>();
+    if (d < 2)
+        return (m & g.step_from[0][d]) >> -g.step_shift[0][d] | (m & g.step_from[1][d]) >> -g.step_shift[1][d];
+    return (m & g.step_from[0][d]) << g.step_shift[0][d] | (m & g.step_from[1][d]) << g.step_shift[1][d];
+}
@@ -0,0 +1,383 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Журнал партии для восстановления после падения или перезапуска. Файл: заголовок journal_header, затем записи
+// journal_record фиксированного размера. Файл отображен в память и растет блоками по GROW_RECORDS записей,
+// поэтому запись хода - копирование 24 байт без системных вызовов; после падения процесса страницы остаются
+// в кэше ОС и попадают на диск. Каждая запись содержит свой номер, поколение журнала и CRC-32:
+// при чтении берутся записи подряд с начала до первой поврежденной или оставшейся от прошлой партии.
+struct journal_header
+{
+    char magic[4];        // "CKJN"
+    uint32_t version;     // JOURNAL_VERSION
+    uint32_t record_size; // sizeof(journal_record)
+    uint32_t generation;  // растет при каждой новой партии, старые записи становятся недействительными
+};
+
+struct journal_record
+{
+    // STEP - шаг хода (Board::move_piece), ROLLBACK - откат Board::rollback,
+    // TURN - начало хода value (доска согласована), END - партия закончена
+    enum : uint8_t
+    {
+        STEP = 1,
+        ROLLBACK = 2,
+        TURN = 3,
+        END = 4
+    };
+
+    uint32_t seq;           // номер записи с начала журнала
+    uint8_t kind;
+    int8_t x, y, x2, y2;    // шаг: откуда и куда
+    int8_t xb, yb;          // взятая фигура или -1
+    uint8_t promote;        // шашка стала дамкой на этом шаге
+    int32_t value;          // STEP - серия взятий, TURN - номер хода
+    uint32_t generation;
+    uint32_t crc;           // CRC-32 предыдущих байт записи
+};
+
+static_assert(sizeof(journal_header) == 16, "journal header must stay 16 bytes");
+static_assert(sizeof(journal_record) == 24, "journal record must stay 24 bytes");
+
+// Журнал пишет игровой поток. На Windows вместо отображения файла запись дописывается в конец и сбрасывается fflush
+class GameJournal
+{
+  public:
+    static constexpr uint32_t JOURNAL_VERSION = 1;
+    static constexpr size_t GROW_RECORDS = 4096;
+
+    GameJournal() = default;
+    GameJournal(const GameJournal &) = delete;
+    GameJournal &operator=(const GameJournal &) = delete;
+
+    ~GameJournal()
+    {
+        close();
+    }
+
+    // Открывает или создает журнал и находит действительные записи; false - файл не открылся
+    bool open(const string &path)
+    {
+        close();
+        this->path = path;
+#ifndef _WIN32
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            close();
+            return false;
+        }
+        const size_t file_size = size_t(st.st_size);
+        const size_t capacity = file_size > sizeof(journal_header)
+                                    ? (file_size - sizeof(journal_header)) / sizeof(journal_record)
+                                    : 0;
+        if (!map(max(capacity, GROW_RECORDS)))
+        {
+            close();
+            return false;
+        }
+        if (!valid_header(*head))
+            init_header(0);
+        while (count < capacity && valid(records_ptr[count], count))
+            ++count;
+        // за поврежденной записью могут остаться целые записи той же партии: дописанные после нее, они бы ожили
+        clear_tail(count, capacity);
+#else
+        FILE *f = fopen(path.c_str(), "rb");
+        journal_header h = {};
+        if (f && fread(&h, sizeof(h), 1, f) == 1 && valid_header(h))
+        {
+            header = h;
+            journal_record rec;
+            while (fread(&rec, sizeof(rec), 1, f) == 1 && valid(rec, loaded.size()))
+                loaded.push_back(rec);
+        }
+        else
+        {
+            init_header(0);
+        }
+        if (f)
+            fclose(f);
+        count = loaded.size();
+        rewrite();
+        if (!file)
+            return false;
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        unmap();
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+#else
+        if (file)
+            fclose(file);
+        file = nullptr;
+        loaded.clear();
+#endif
+        count = 0;
+    }
+
+    bool is_open() const
+    {
+#ifndef _WIN32
+        return fd >= 0;
+#else
+        return file != nullptr;
+#endif
+    }
+
+    // Действительные записи по порядку
+    vector<journal_record> records() const
+    {
+#ifndef _WIN32
+        return vector<journal_record>(records_ptr, records_ptr + count);
+#else
+        return vector<journal_record>(loaded.begin(), loaded.begin() + count);
+#endif
+    }
+
+    // Новая партия: записи прошлой становятся недействительными сменой поколения
+    void reset()
+    {
+        if (!is_open())
+            return;
+#ifndef _WIN32
+        init_header(head->generation + 1);
+        count = 0;
+        sync();
+#else
+        init_header(header.generation + 1);
+        loaded.clear();
+        count = 0;
+        rewrite();
+#endif
+    }
+
+    // Оставляет первые n записей, остальные стираются
+    void truncate(const size_t n)
+    {
+        if (n >= count)
+            return;
+#ifndef _WIN32
+        clear_tail(n, count);
+        count = n;
+#else
+        count = n;
+        loaded.resize(count);
+        rewrite();
+#endif
+    }
+
+    void step(const move_pos &turn, const bool promote, const int beat_series)
+    {
+        journal_record rec = make(journal_record::STEP, beat_series);
+        rec.x = int8_t(turn.x);
+        rec.y = int8_t(turn.y);
+        rec.x2 = int8_t(turn.x2);
+        rec.y2 = int8_t(turn.y2);
+        rec.xb = int8_t(turn.xb);
+        rec.yb = int8_t(turn.yb);
+        rec.promote = promote;
+        append(rec);
+    }
+
+    void rollback()
+    {
+        append(make(journal_record::ROLLBACK, 0));
+    }
+
+    void turn(const int turn_num)
+    {
+        append(make(journal_record::TURN, turn_num));
+    }
+
+    // Конец партии сразу сбрасывается на диск
+    void end()
+    {
+        append(make(journal_record::END, 0));
+        sync();
+    }
+
+    // Дожидается записи отображенных страниц на диск (конец партии, новая партия)
+    void sync()
+    {
+#ifndef _WIN32
+        if (head)
+            msync(head, mapped_size, MS_SYNC);
+#endif
+    }
+
+  private:
+    static uint32_t crc32(const void *data, const size_t size)
+    {
+        static const auto table = []() {
+            vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        const uint8_t *bytes = (const uint8_t *)data;
+        for (size_t i = 0; i < size; ++i)
+            crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    static bool valid_header(const journal_header &h)
+    {
+        return memcmp(h.magic, "CKJN", 4) == 0 && h.version == JOURNAL_VERSION && h.record_size == sizeof(journal_record);
+    }
+
+    bool valid(const journal_record &rec, const size_t index) const
+    {
+        return rec.seq == index && rec.generation == generation() &&
+               rec.crc == crc32(&rec, offsetof(journal_record, crc));
+    }
+
+    uint32_t generation() const
+    {
+#ifndef _WIN32
+        return head->generation;
+#else
+        return header.generation;
+#endif
+    }
+
+    journal_record make(const uint8_t kind, const int32_t value) const
+    {
+        journal_record rec = {};
+        rec.kind = kind;
+        rec.x = rec.y = rec.x2 = rec.y2 = rec.xb = rec.yb = -1;
+        rec.value = value;
+        return rec;
+    }
+
+    void append(journal_record rec)
+    {
+        if (!is_open())
+            return;
+        rec.seq = uint32_t(count);
+        rec.generation = generation();
+        rec.crc = crc32(&rec, offsetof(journal_record, crc));
+#ifndef _WIN32
+        if (count == capacity() && !map(capacity() + GROW_RECORDS))
+            return;
+        records_ptr[count++] = rec;
+#else
+        loaded.push_back(rec);
+        ++count;
+        fwrite(&rec, sizeof(rec), 1, file);
+        fflush(file);
+#endif
+    }
+
+    void init_header(const uint32_t generation)
+    {
+        journal_header h;
+        memcpy(h.magic, "CKJN", 4);
+        h.version = JOURNAL_VERSION;
+        h.record_size = sizeof(journal_record);
+        h.generation = generation;
+#ifndef _WIN32
+        *head = h;
+#else
+        header = h;
+#endif
+    }
+
+#ifndef _WIN32
+    size_t capacity() const
+    {
+        return (mapped_size - sizeof(journal_header)) / sizeof(journal_record);
+    }
+
+    // Отображает файл на records записей, при необходимости увеличивая его (новые байты - нули)
+    bool map(const size_t records)
+    {
+        const size_t size = sizeof(journal_header) + records * sizeof(journal_record);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t(st.st_size) < size && ftruncate(fd, off_t(size)) != 0))
+            return false;
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+            return false;
+        unmap();
+        head = (journal_header *)ptr;
+        records_ptr = (journal_record *)(head + 1);
+        mapped_size = size;
+        return true;
+    }
+
+    // Стирает записи текущего поколения с номерами [from, to)
+    void clear_tail(const size_t from, const size_t to)
+    {
+        for (size_t k = from; k < to; ++k)
+            if (records_ptr[k].crc != 0 && records_ptr[k].generation == head->generation)
+                memset(&records_ptr[k], 0, sizeof(journal_record));
+    }
+
+    void unmap()
+    {
+        if (head)
+            munmap(head, mapped_size);
+        head = nullptr;
+        records_ptr = nullptr;
+        mapped_size = 0;
+    }
+
+    int fd = -1;
+    journal_header *head = nullptr;
+    journal_record *records_ptr = nullptr;
+    size_t mapped_size = 0;
+#else
+    // Файл переписывается целиком при открытии, новой партии и отбрасывании записей, дальше только дописывается
+    void rewrite()
+    {
+        if (file)
+            fclose(file);
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            return;
+        fwrite(&header, sizeof(header), 1, file);
+        if (!loaded.empty())
+            fwrite(loaded.data(), sizeof(journal_record), loaded.size(), file);
+        fflush(file);
+    }
+
+    FILE *file = nullptr;
+    journal_header header = {};
+    vector<journal_record> loaded;
+#endif
+    string path;
+    size_t count = 0;
+};
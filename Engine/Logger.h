@@ -0,0 +1,242 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Настройки журнала: GUI берет их из settings.json (Config::get_logger_settings), CLI - из аргументов
+struct logger_settings
+{
+    string path = "log.txt";
+    size_t max_size_kb = 1024; // при превышении файл переименовывается в path.1, path.1 - в path.2 и т.д.
+    int max_files = 3;         // сколько старых файлов хранить
+    size_t capacity = 4096;    // размер кольцевого буфера в записях (округляется до степени двойки)
+};
+
+// Запись журнала фиксированного размера, чтобы кольцевой буфер не выделял память
+struct log_record
+{
+    int64_t time_ms = 0;     // время записи, мс от эпохи Unix
+    char event[24] = {};     // тип события: bot_turn, game_end, error, ...
+    char move[64] = {};      // ход в нотации turns_to_string
+    int64_t duration_us = -1; // длительность события, -1 - не задана
+    int64_t value = 0;       // число, зависящее от события (узлы поиска, результат партии, номер хода)
+    char text[128] = {};     // текст ошибки или комментарий
+};
+
+// Журнал в формате JSON lines. Игровой поток только кладет запись в кольцевой буфер без блокировок и системных вызовов,
+// фоновый поток раз в FLUSH_INTERVAL_MS пишет накопленные записи одним блоком и переименовывает файл по размеру.
+// Если буфер переполнен, запись отбрасывается, а число потерянных записей попадает в журнал событием "dropped".
+class Logger
+{
+  public:
+    static constexpr int FLUSH_INTERVAL_MS = 50;
+
+    Logger(const logger_settings &settings) : settings(settings)
+    {
+        size_t count = 2;
+        while (count < settings.capacity)
+            count *= 2;
+        slots.reset(new slot[count]);
+        mask = count - 1;
+        for (size_t i = 0; i < count; ++i)
+            slots[i].seq.store(i, memory_order_relaxed);
+
+        // журнал прошлого запуска сохраняется как path.1
+        rotate();
+        fout.open(settings.path, ios_base::trunc);
+        writer = thread(&Logger::run, this);
+    }
+
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+
+    ~Logger()
+    {
+        stop.store(true, memory_order_release);
+        writer.join();
+    }
+
+    void log(const string &event, const string &move = "", const int64_t duration_us = -1, const int64_t value = 0,
+             const string &text = "")
+    {
+        log_record rec;
+        rec.time_ms = chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        copy_field(rec.event, event);
+        copy_field(rec.move, move);
+        rec.duration_us = duration_us;
+        rec.value = value;
+        copy_field(rec.text, text);
+        push(rec);
+    }
+
+    // Кладет запись в буфер (очередь Вьюкова: несколько писателей, один читатель)
+    bool push(const log_record &rec)
+    {
+        size_t pos = head.load(memory_order_relaxed);
+        while (true)
+        {
+            slot &s = slots[pos & mask];
+            const size_t seq = s.seq.load(memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    s.rec = rec;
+                    s.seq.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                dropped.fetch_add(1, memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = head.load(memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    struct slot
+    {
+        atomic<size_t> seq;
+        log_record rec;
+    };
+
+    template <size_t N> static void copy_field(char (&dst)[N], const string &src)
+    {
+        const size_t len = min(src.size(), N - 1);
+        memcpy(dst, src.data(), len);
+        dst[len] = 0;
+    }
+
+    bool pop(log_record &rec)
+    {
+        slot &s = slots[tail & mask];
+        if (s.seq.load(memory_order_acquire) != tail + 1)
+            return false;
+        rec = s.rec;
+        s.seq.store(tail + mask + 1, memory_order_release);
+        ++tail;
+        return true;
+    }
+
+    void run()
+    {
+        string buffer;
+        log_record rec;
+        while (true)
+        {
+            const bool last = stop.load(memory_order_acquire);
+            while (pop(rec))
+                append_json(buffer, rec);
+            if (const size_t lost = dropped.exchange(0, memory_order_relaxed))
+            {
+                log_record note;
+                note.time_ms =
+                    chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+                copy_field(note.event, "dropped");
+                note.value = int64_t(lost);
+                append_json(buffer, note);
+            }
+            if (!buffer.empty())
+            {
+                fout << buffer;
+                fout.flush();
+                written += buffer.size();
+                buffer.clear();
+                if (written > settings.max_size_kb * 1024)
+                {
+                    fout.close();
+                    rotate();
+                    fout.open(settings.path, ios_base::trunc);
+                    written = 0;
+                }
+            }
+            if (last)
+                break;
+            this_thread::sleep_for(chrono::milliseconds(FLUSH_INTERVAL_MS));
+        }
+    }
+
+    // path.(n-1) -> path.n, ..., path -> path.1; самый старый файл удаляется
+    void rotate() const
+    {
+        if (settings.max_files <= 0)
+            return;
+        const auto name = [&](const int i) { return i ? settings.path + "." + to_string(i) : settings.path; };
+        remove(name(settings.max_files).c_str());
+        for (int i = settings.max_files - 1; i >= 0; --i)
+            rename(name(i).c_str(), name(i + 1).c_str());
+    }
+
+    static void append_string(string &out, const char *s)
+    {
+        out += '"';
+        for (; *s; ++s)
+        {
+            const unsigned char c = *s;
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += char(c);
+            }
+            else if (c < 0x20)
+            {
+                char esc[8];
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                out += esc;
+            }
+            else
+            {
+                out += char(c);
+            }
+        }
+        out += '"';
+    }
+
+    // {"time_ms":..,"event":"..","move":"..","duration_us":..,"value":..,"text":".."}, пустые поля пропускаются
+    static void append_json(string &out, const log_record &rec)
+    {
+        out += "{\"time_ms\":" + to_string(rec.time_ms) + ",\"event\":";
+        append_string(out, rec.event);
+        if (rec.move[0])
+        {
+            out += ",\"move\":";
+            append_string(out, rec.move);
+        }
+        if (rec.duration_us >= 0)
+            out += ",\"duration_us\":" + to_string(rec.duration_us);
+        out += ",\"value\":" + to_string(rec.value);
+        if (rec.text[0])
+        {
+            out += ",\"text\":";
+            append_string(out, rec.text);
+        }
+        out += "}\n";
+    }
+
+    logger_settings settings;
+    unique_ptr<slot[]> slots;
+    size_t mask = 0;
+    atomic<size_t> head{0};
+    size_t tail = 0; // только для фонового потока
+    atomic<size_t> dropped{0};
+    atomic<bool> stop{false};
+    ofstream fout;
+    size_t written = 0;
+    thread writer;
+};
@@ -0,0 +1,858 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Models/Analysis.h"
+#include "../Models/Move.h"
+#include "Eval_weights.h"
+#include "Logic_settings.h"
+#include "Movegen.h"
+#include "Nnue.h"
+#include "Rules.h"
+#include "Transposition.h"
+
+using namespace std;
+
+const int INF = 1e9;
+
+// Оценки - целые числа с точки зрения стороны, которая ходит; SCORE_SCALE единиц - единица логарифма отношения сил.
+// Выигрыш через n ходов (ход из анализируемой позиции - первый) равен WIN_SCORE - n, проигрыш - -(WIN_SCORE - n).
+const int SCORE_SCALE = 1000;
+const int WIN_SCORE = 1000000;
+// Оценки по модулю больше WIN_BOUND - доказанный выигрыш или проигрыш
+const int WIN_BOUND = WIN_SCORE - 10000;
+// Полуширина окна вокруг оценки прошлого уровня
+const int ASPIRATION_WINDOW = 50;
+// Выборочный поиск (Optimization "O2"): тихие ходы после первых LMR_MOVES ищутся на уровень меньше, если до листьев
+// остается не меньше LMR_MIN_REMAINING ходов; за ход до листьев тихие ходы не перебираются, если оценка позиции
+// с запасом FUTILITY_MARGIN не дотягивает до alpha. В позициях со взятиями выборочности нет.
+const int LMR_MIN_REMAINING = 3;
+const size_t LMR_MOVES = 3;
+const int FUTILITY_MARGIN = 200;
+
+// Оценка для вывода: число или "win in N" / "loss in N"
+inline string score_to_string(const int score)
+{
+    if (score > WIN_BOUND)
+        return "win in " + to_string(WIN_SCORE - score);
+    if (score < -WIN_BOUND)
+        return "loss in " + to_string(WIN_SCORE + score);
+    return to_string(score);
+}
+
+// Логика бота не зависит от SDL и json: доска передается матрицей, настройки - структурой logic_settings.
+// Logic - интерфейс для кода, который выбирает размер доски и правила во время работы (GUI по settings.json):
+// виртуальные вызовы только на границе, поиск целиком внутри BoardLogic<N, Rules>.
+class Logic
+{
+  public:
+    virtual ~Logic() = default;
+
+    virtual vector<move_pos> find_best_turns(const bool color, const vector<vector<POS_T>> &mtx) = 0;
+    virtual vector<analysis_line> find_best_lines(const bool color, const vector<vector<POS_T>> &mtx,
+                                                  const size_t count) = 0;
+    // Новая партия: позиции партии забываются, случайный выбор корня начинается заново с Seed;
+    // таблица транспозиций остается (ее очищает только clear_cache)
+    virtual void new_game() = 0;
+    // Новый Seed (0 - от часов), как если бы бот был создан с ним; таблица транспозиций остается
+    virtual void set_seed(const unsigned seed) = 0;
+    virtual vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const = 0;
+    virtual bool promotes(const vector<vector<POS_T>> &mtx, const move_pos &turn) const = 0;
+    virtual bool continues_capture(const vector<vector<POS_T>> &mtx, const move_pos &turn) const = 0;
+    virtual int calc_score(const vector<vector<POS_T>> &mtx, const bool color) const = 0;
+    virtual void find_turns(const bool color, const vector<vector<POS_T>> &mtx) = 0;
+    virtual void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx) = 0;
+    virtual vector<vector<move_pos>> find_all_turns(const bool color, const vector<vector<POS_T>> &mtx) const = 0;
+
+    // Кэш поиска на диске (таблица транспозиций): false - не сохранился или у бота нет кэша
+    virtual bool save_cache(const string &/*path*/) const
+    {
+        return false;
+    }
+
+    // Добавляет записи кэша из файла; число загруженных записей
+    virtual size_t load_cache(const string &/*path*/)
+    {
+        return 0;
+    }
+
+    // Забывает результаты прошлых поисков: следующий поиск не зависит от прошлых партий
+    virtual void clear_cache()
+    {
+    }
+
+    // Список возможных ходов для текущей позиции
+    vector<move_pos> turns;
+    // Флаг, который указывает, были ли выполнены побеждения в текущем ходе
+    bool have_beats = false;
+    // Максимальная глубина поиска для алгоритмов, таких как минимакс или альфа-бета отсечение
+    int Max_depth = 0;
+    // Количество узлов, посещенных последним вызовом find_best_turns
+    size_t nodes = 0;
+    // Оценка хода, выбранного последним вызовом find_best_turns (с точки зрения сделавшего ход)
+    int score = 0;
+    // Позиции партии перед ходами с последнего необратимого хода, без текущей (position_history::previous);
+    // поиск считает ничьей возврат в любую из них
+    vector<vector<vector<POS_T>>> history;
+};
+
+// Поиск внутри работает с масками bit_position<N>; N - размер доски (8 или 10, см. Geometry.h), Rules - правила
+// варианта (см. Rules.h). Для каждой пары генератор ходов, хеши и оценка компилируются отдельно.
+template <int N, class Rules = russian_rules> class BoardLogic final : public Logic
+{
+  public:
+    using geo = board_geometry<N>;
+    using position = bit_position<N>;
+    using gen = movegen<N, Rules>;
+
+    BoardLogic(const logic_settings &settings)
+    {
+        // случайность только в корне: выбор среди ходов с оценкой не хуже лучшей на random_margin
+        randomize = !settings.no_random;
+        random_margin = max(settings.random_margin, 0);
+        seed = settings.seed;
+        rand_eng = std::default_random_engine(seed ? seed : unsigned(time(0)));
+        weights = eval_weights::preset(settings.scoring_mode);
+        if (!settings.weights_path.empty() && !weights.load(settings.weights_path))
+            throw runtime_error("can't load eval weights from " + settings.weights_path);
+        if (settings.scoring_mode == "NNUE")
+        {
+            if (N != 8)
+                throw runtime_error("NNUE scoring supports only the 8x8 board");
+            auto net = make_shared<nnue_network>();
+            if (!net->load(settings.nnue_path))
+                throw runtime_error("can't load NNUE network from " + settings.nnue_path);
+            nnue = net;
+        }
+        pruning = settings.optimization != "O0";
+        selective_search = settings.optimization == "O2";
+        string tt_error;
+        if (settings.tt_shared.empty())
+            tt.resize(settings.tt_size_mb);
+        else if (!tt.attach_shared(settings.tt_shared, settings.tt_size_mb, cache_fingerprint(), tt_error))
+            throw runtime_error(tt_error);
+        if (!settings.cache_path.empty())
+            load_cache(settings.cache_path);
+    }
+
+    // Ход бота. Без NoRandom ходы корня перемешиваются перед поиском, и выбирается случайный из ходов
+    // с оценкой не хуже лучшей на random_margin; поиск внутри дерева детерминирован, поэтому при одном Seed
+    // партия повторяется полностью.
+    vector<move_pos> find_best_turns(const bool color, const vector<vector<POS_T>> &mtx) override
+    {
+        auto lines = search_lines(color, position::from_mtx(mtx), 1, randomize ? random_margin : 0);
+        if (lines.empty())
+            return {};
+        size_t candidates = 1;
+        // доказанный выигрыш не размениваем на более долгий
+        if (randomize && lines[0].score <= WIN_BOUND)
+        {
+            while (candidates < lines.size() && lines[candidates].score >= lines[0].score - random_margin)
+                ++candidates;
+        }
+        const auto &chosen = lines[candidates > 1 ? rand_eng() % candidates : 0];
+        score = chosen.score;
+        return chosen.turns;
+    }
+
+    // С заданным Seed генератор возвращается в начало: при холодной таблице партия повторяется.
+    // Без Seed (0) генератор продолжает свою последовательность
+    void new_game() override
+    {
+        if (seed)
+            rand_eng.seed(seed);
+        history.clear();
+    }
+
+    void set_seed(const unsigned new_seed) override
+    {
+        seed = new_seed;
+        rand_eng.seed(seed ? seed : unsigned(time(0)));
+    }
+
+    // Общая таблица (tt_shared) не очищается: в ней работа других процессов
+    void clear_cache() override
+    {
+        if (!tt.is_shared())
+            tt.clear();
+    }
+
+    // Таблица транспозиций в файле (20 байт на непустую запись) с отпечатком правил и оценки и контрольной суммой
+    bool save_cache(const string &path) const override
+    {
+        return tt.save(path, cache_fingerprint());
+    }
+
+    size_t load_cache(const string &path) override
+    {
+        return tt.load(path, cache_fingerprint(), N);
+    }
+
+    // Мульти-PV: count лучших ходов с оценками и продолжениями за один поиск.
+    // Уровни 0..Max_depth перебираются по очереди, на каждом ходы упорядочены по оценкам прошлого уровня,
+    // а внутри дерева - по таблице транспозиций. Ходы хуже count-го лучшего отсекаются по alpha.
+    // Уровень ищется в окне вокруг прошлой оценки; если лучший или count-й ход выходит за окно, уровень повторяется
+    // с открытой границей. Доказанный выигрыш останавливает углубление: более короткого выигрыша уже нет.
+    vector<analysis_line> find_best_lines(const bool color, const vector<vector<POS_T>> &mtx, const size_t count) override
+    {
+        const position pos = position::from_mtx(mtx);
+        auto lines = search_lines(color, pos, count, 0);
+        if (lines.size() > count)
+            lines.resize(count);
+        for (auto &line : lines)
+            line.pv = principal_variation(color, pos, line.turns);
+        return lines;
+    }
+
+    // Все ходы стороны color целиком: серия взятий - один ход из нескольких шагов
+    vector<vector<move_pos>> find_all_turns(const bool color, const vector<vector<POS_T>> &mtx) const override
+    {
+        return expand_turns(color, position::from_mtx(mtx));
+    }
+
+    // Применяет один шаг хода к копии доски (используется в поиске и в консольных партиях)
+    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const override
+    {
+        // Если фигура достигла своей последней линии (для белых - 0, для черных - N - 1), превращаем ее в дамку,
+        // если это разрешают правила (проверяется до снятия побежденной фигуры)
+        if (promotes(mtx, turn))
+            mtx[turn.x][turn.y] += 2;  // Превращаем фигуру в дамку (прибавляем 2 к значению)
+
+        // Если был побежден противник, очищаем соответствующую клетку
+        if (turn.xb != -1)
+            mtx[turn.xb][turn.yb] = 0;  // Убираем побежденную фигуру с доски
+
+        // Перемещаем фигуру из исходной клетки в целевую
+        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];  // Ставим фигуру на новое место
+
+        // Очищаем исходную клетку
+        mtx[turn.x][turn.y] = 0;  // Убираем фигуру с исходной клетки
+
+        return mtx;  // Возвращаем измененную доску
+    }
+
+    // Становится ли фигура дамкой на шаге turn (mtx - доска до шага)
+    bool promotes(const vector<vector<POS_T>> &mtx, const move_pos &turn) const override
+    {
+        if (!((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == N - 1)))
+            return false;
+        return gen::promotes(position::from_mtx(mtx), turn);
+    }
+
+    // Продолжает ли фигура взятие после шага turn (mtx - доска до шага); иначе ход переходит к сопернику
+    bool continues_capture(const vector<vector<POS_T>> &mtx, const move_pos &turn) const override
+    {
+        return turn.xb != -1 && gen::continues_capture(position::from_mtx(mtx), turn);
+    }
+
+    // Оценка позиции с точки зрения color. Если у color нет фигур, возвращается -WIN_SCORE, если у соперника - WIN_SCORE
+    int calc_score(const vector<vector<POS_T>>& mtx, const bool color) const override
+    {
+        return calc_score(position::from_mtx(mtx), color);
+    }
+
+    int calc_score(const position& pos, const bool color) const
+    {
+        // Для нейросетевой оценки аккумулятор считается с нуля; в поиске он обновляется по ходам (см. make_search_turn)
+        if constexpr (N == 8)
+        {
+            if (nnue)
+            {
+                nnue_accumulator acc;
+                acc.refresh(*nnue, pos);
+                return nnue_score(acc, color);
+            }
+        }
+        return material_score(pos, color);
+    }
+
+    // Оценка нейросетью в той же шкале, что и calc_score
+    int nnue_score(const nnue_accumulator& acc, const bool color) const
+    {
+        if (acc.count[color] == 0)
+            return -WIN_SCORE;
+        if (acc.count[!color] == 0)
+            return WIN_SCORE;
+        // выход сети - логит результата для белых
+        const double logit = acc.evaluate(*nnue);
+        const int score = int(lround(SCORE_SCALE * logit));
+        return max(-WIN_BOUND, min(WIN_BOUND, color ? -score : score));
+    }
+
+private:
+    // Оценка по весам: признаки (количество шашек, дамок, продвижение и т.д.) считаются по маскам
+    int material_score(const position& pos, const bool color) const
+    {
+        eval_features mine, theirs;
+        extract_features(pos, mine, theirs);
+        if (color)
+            swap(mine, theirs);
+
+        if (mine.men + mine.kings == 0)
+            return -WIN_SCORE;
+        if (theirs.men + theirs.kings == 0)
+            return WIN_SCORE;
+
+        // Логарифм отношения взвешенных оценок сторон; веса задаются BotScoringType или файлом EvalWeights
+        const double ratio = max(weights.material(mine), 1e-3) / max(weights.material(theirs), 1e-3);
+        return int(lround(SCORE_SCALE * log(ratio)));
+    }
+
+    // Ход внутри поиска: для нейросетевой оценки также готовит аккумулятор следующего уровня
+    position make_search_turn(const position& pos, const move_pos& turn)
+    {
+        if (hash_stack.size() <= ply + 1)
+        {
+            hash_stack.resize(ply + 2);
+            quiet_stack.resize(ply + 2);
+        }
+        const position next = gen::apply(pos, turn);
+        hash_stack[ply + 1] = hash_stack[ply] ^ board_hash_delta(pos, next);
+        const bool quiet = turn.xb == -1 && next.men[0] == pos.men[0] && next.men[1] == pos.men[1];
+        quiet_stack[ply + 1] = quiet ? quiet_stack[ply] + 1 : 0;
+        if constexpr (N == 8)
+        {
+            if (nnue)
+            {
+                if (acc_stack.size() <= ply + 1)
+                    acc_stack.resize(ply + 2);
+                acc_stack[ply + 1] = acc_stack[ply];
+                acc_stack[ply + 1].update(*nnue, pos, next);
+            }
+        }
+        ++ply;
+        return next;
+    }
+
+    // Возврат на уровень выше после make_search_turn
+    void undo_search_turn()
+    {
+        --ply;
+    }
+
+    // Все ходы стороны color, серия взятий раскрывается в один ход
+    vector<vector<move_pos>> expand_turns(const bool color, const position &pos) const
+    {
+        vector<vector<move_pos>> res;
+        vector<move_pos> moves;
+        const bool has_beats = gen::generate(pos, color, moves);
+        for (const auto &turn : moves)
+        {
+            vector<move_pos> path{turn};
+            if (has_beats && gen::continues_capture(pos, turn))
+                expand_beats(gen::apply(pos, turn), path, res);
+            else
+                res.push_back(path);
+        }
+        return res;
+    }
+
+    void expand_beats(const position &pos, vector<move_pos> &path, vector<vector<move_pos>> &res) const
+    {
+        vector<move_pos> moves;
+        if (!gen::generate_from(pos, geo::square(path.back().x2, path.back().y2), moves))
+        {
+            res.push_back(path);
+            return;
+        }
+        for (const auto &turn : moves)
+        {
+            path.push_back(turn);
+            if (gen::continues_capture(pos, turn))
+                expand_beats(gen::apply(pos, turn), path, res);
+            else
+                res.push_back(path);
+            path.pop_back();
+        }
+    }
+
+    // Ничья по правилам в узле: позиция уже была в этой ветке или в партии (history) с той же стороной хода,
+    // или 2 * QUIET_DRAW_MOVES ходов подряд никто не бьет и не ходит шашкой. Внутри обратимых ходов каждый уровень -
+    // целый ход, поэтому позиции с той же стороной хода стоят через один. Уровень, от которого зависит ничья
+    // (повторенная позиция или начало обратимых ходов, отрицательный - в партии), попадает в draw_reach
+    bool rule_draw()
+    {
+        const int quiet = quiet_stack[ply];
+        if (quiet >= 2 * Rules::QUIET_DRAW_MOVES)
+        {
+            draw_reach = min(draw_reach, int(ply) - quiet);
+            return true;
+        }
+        for (int back = 2; back <= quiet; back += 2)
+        {
+            const int i = int(ply) - back;
+            if ((i >= 0 ? hash_stack[i] : game_hashes[game_hashes.size() + i]) == hash_stack[ply])
+            {
+                draw_reach = min(draw_reach, i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Ключ узла: расстановка, сторона хода и фигура, которая обязана продолжить взятие
+    uint64_t node_key(const bool color, const POS_T x, const POS_T y) const
+    {
+        uint64_t key = hash_stack[ply] ^ (color ? zobrist().side : 0);
+        if (x != -1)
+            key ^= zobrist().forced[geo::square(x, y)];
+        return key;
+    }
+
+    // Продолжение после хода root_turns по лучшим ходам из таблицы транспозиций
+    vector<vector<move_pos>> principal_variation(bool color, position pos, const vector<move_pos> &root_turns) const
+    {
+        for (const auto &turn : root_turns)
+            pos = gen::apply(pos, turn);
+        color = !color;
+
+        vector<vector<move_pos>> pv;
+        vector<move_pos> moves;
+        for (int step = 0; step < search_depth + 1; ++step)
+        {
+            vector<move_pos> full_turn;
+            POS_T x = -1, y = -1;
+            while (true)
+            {
+                bool has_beats;
+                if (x != -1)
+                    has_beats = gen::generate_from(pos, geo::square(x, y), moves);
+                else
+                    has_beats = gen::generate(pos, color, moves);
+                if (x != -1 && !has_beats)
+                    break;
+
+                uint64_t key = board_hash(pos) ^ (color ? zobrist().side : 0);
+                if (x != -1)
+                    key ^= zobrist().forced[geo::square(x, y)];
+                tt_entry entry;
+                if (!tt.probe(key, entry) || find(moves.begin(), moves.end(), entry.move) == moves.end())
+                    break;
+
+                const move_pos turn = *find(moves.begin(), moves.end(), entry.move);
+                full_turn.push_back(turn);
+                const bool continues = gen::continues_capture(pos, turn);
+                pos = gen::apply(pos, turn);
+                if (!continues)
+                    break;
+                x = turn.x2;
+                y = turn.y2;
+            }
+            if (full_turn.empty())
+                break;
+            pv.push_back(full_turn);
+            color = !color;
+        }
+        return pv;
+    }
+
+    // Итеративное углубление по ходам корня; точные оценки получают count лучших ходов и ходы,
+    // уступающие count-му не больше margin. Возвращает все ходы корня по убыванию оценки.
+    vector<analysis_line> search_lines(const bool color, const position &pos, const size_t count, const int margin)
+    {
+        nodes = 0;
+        ply = 0;
+        reduction = 0;
+        draw_reach = INT_MAX;
+        hash_stack[0] = board_hash(pos);
+        game_hashes.clear();
+        for (const auto &mtx : history)
+            game_hashes.push_back(board_hash(position::from_mtx(mtx)));
+        quiet_stack[0] = int(game_hashes.size());
+        if constexpr (N == 8)
+        {
+            if (nnue)
+                acc_stack[0].refresh(*nnue, pos);
+        }
+
+        vector<analysis_line> lines;
+        for (auto &turns : expand_turns(color, pos))
+        {
+            lines.emplace_back();
+            lines.back().turns = turns;
+        }
+        if (randomize)
+            shuffle(lines.begin(), lines.end(), rand_eng);
+
+        for (int level = 0; level <= Max_depth && !lines.empty(); ++level)
+        {
+            search_depth = level;
+            const int prev = lines[0].score;
+            const bool use_window = level > 0 && pruning && abs(prev) < WIN_BOUND;
+            int low = use_window ? prev - ASPIRATION_WINDOW - margin : -INF;
+            int high = use_window ? prev + ASPIRATION_WINDOW : INF;
+            while (true)
+            {
+                search_root(color, pos, lines, count, margin, low, high);
+                const size_t last = min(count, lines.size()) - 1;
+                if (lines[0].score >= high)
+                    high = INF;
+                else if (lines[last].score <= low)
+                    low = -INF;
+                else
+                    break;
+            }
+            if (lines[0].score > WIN_BOUND)
+                break;
+        }
+
+        return lines;
+    }
+
+    // Один уровень мульти-PV: оценивает ходы корня в окне (low, high) и сортирует их по убыванию оценки
+    void search_root(const bool color, const position &pos, vector<analysis_line> &lines,
+                     const size_t count, const int margin, const int low, const int high)
+    {
+        vector<int> scores;
+        for (auto &line : lines)
+        {
+            // alpha - оценка count-го лучшего хода на этом уровне
+            int alpha = low;
+            if (scores.size() >= count)
+            {
+                auto sorted = scores;
+                nth_element(sorted.begin(), sorted.begin() + (count - 1), sorted.end(), greater<int>());
+                alpha = max(alpha, sorted[count - 1] - margin);
+            }
+
+            position next = pos;
+            for (const auto &turn : line.turns)
+                next = make_search_turn(next, turn);
+            line.score = -find_best_turns_rec(next, !color, 0, -high, -alpha);
+            line.depth = search_depth;
+            for (size_t i = 0; i < line.turns.size(); ++i)
+                undo_search_turn();
+            scores.push_back(line.score);
+        }
+        // ходы с равной оценкой сохраняют порядок предыдущего уровня
+        stable_sort(lines.begin(), lines.end(),
+                    [](const analysis_line &a, const analysis_line &b) { return a.score > b.score; });
+    }
+
+    // Оценка листа; -WIN_SCORE из calc_score (нет фигур) переводится в проигрыш с учетом числа сделанных ходов
+    int leaf_score(const position& pos, const bool color, const int turns_played) const
+    {
+        const int score = nnue ? nnue_score(acc_stack[ply], color) : material_score(pos, color);
+        if (score == -WIN_SCORE)
+            return -(WIN_SCORE - turns_played);
+        return score;
+    }
+
+    // Оценки выигрыша хранятся в таблице относительно узла, а не корня
+    static int score_to_tt(const int score, const int turns_played)
+    {
+        return score > WIN_BOUND ? score + turns_played : score < -WIN_BOUND ? score - turns_played : score;
+    }
+
+    static int score_from_tt(const int score, const int turns_played)
+    {
+        return score > WIN_BOUND ? score - turns_played : score < -WIN_BOUND ? score + turns_played : score;
+    }
+
+    // Negamax с альфа-бета отсечением: оценка с точки зрения color.
+    // depth - номер хода после хода из корня, (x, y) - фигура, которая продолжает серию взятий.
+    // При O2 ветка может быть сокращена на reduction уровней (см. LMR_MOVES), листья наступают раньше.
+    int find_best_turns_rec(const position& pos, const bool color, const size_t depth, int alpha, int beta,
+        const POS_T x = -1, const POS_T y = -1)
+    {
+        ++nodes;
+        const int turns_played = int(depth) + 1;
+
+        // Повторение позиции или ходы одними дамками сверх правила - ничья, круг дальше не перебирается
+        if (quiet_stack[ply] >= 2 && rule_draw())
+        {
+            return 0;
+        }
+
+        // Если достигнута максимальная глубина рекурсии, оцениваем положение
+        if (int(depth) + reduction >= search_depth)
+        {
+            return leaf_score(pos, color, turns_played);
+        }
+
+        // Если указан конкретный ход, ищем возможные ходы для него, иначе - взятия текущего игрока.
+        // Тихие ходы генерируются по стадиям: сначала ход из таблицы транспозиций, остальные - только если
+        // он не дал отсечения (quiets_pending)
+        vector<move_pos> current_turns;
+        const bool has_beats = x != -1 ? gen::generate_from(pos, geo::square(x, y), current_turns)
+                                       : gen::generate_captures(pos, color, current_turns);
+
+        // Если нет обязательных взятий и это не первый ход, передаем ход противнику
+        if (!has_beats && x != -1)
+        {
+            return -find_best_turns_rec(pos, !color, depth + 1, -beta, -alpha);
+        }
+
+        // Если ходов нет, текущий игрок проиграл
+        bool quiets_pending = !has_beats;
+        if (quiets_pending && !gen::has_quiets(pos, color))
+        {
+            return -(WIN_SCORE - turns_played);
+        }
+
+        // Быстрее выиграть, чем через один ход, нельзя, а проиграть раньше, чем сейчас, уже поздно
+        if (pruning && x == -1)
+        {
+            alpha = max(alpha, -(WIN_SCORE - turns_played));
+            beta = min(beta, WIN_SCORE - turns_played - 1);
+            if (alpha >= beta)
+                return alpha;
+        }
+
+        // Таблица транспозиций: оценка с достаточной глубины завершает узел, лучший ход проверяем первым
+        const uint64_t key = node_key(color, x, y);
+        const int remaining = search_depth - int(depth) - reduction;
+        tt_entry entry;
+        if (tt.probe(key, entry))
+        {
+            const int score = score_from_tt(entry.score, turns_played);
+            if (pruning && entry.depth >= remaining &&
+                (entry.bound == TT_EXACT || (entry.bound == TT_LOWER && score >= beta) ||
+                 (entry.bound == TT_UPPER && score <= alpha)))
+                return score;
+
+            if (quiets_pending)
+            {
+                if (gen::is_quiet(pos, color, entry.move))
+                    current_turns.push_back(entry.move);
+            }
+            else
+            {
+                auto it = find(current_turns.begin(), current_turns.end(), entry.move);
+                if (it != current_turns.end())
+                    rotate(current_turns.begin(), it, it + 1);
+            }
+        }
+        if (current_turns.empty())
+        {
+            gen::generate_quiets(pos, color, current_turns);
+            quiets_pending = false;
+        }
+
+        const int alpha_orig = alpha;
+        const int outer_draw_reach = draw_reach;
+        draw_reach = INT_MAX;
+        int best_score = -INF;
+        move_pos best_turn = current_turns[0];
+
+        // Оценка шага turn в окне (a, b) с точки зрения color
+        auto search_turn = [&](const move_pos &turn, const int a, const int b) {
+            int score;
+            const position next = make_search_turn(pos, turn);
+            // Если есть взятие и серия не закончилась превращением, продолжаем ход для текущего игрока,
+            // иначе передаём ход противнику
+            if (has_beats && gen::continues_capture(pos, turn))
+                score = find_best_turns_rec(next, color, depth, a, b, turn.x2, turn.y2);
+            else
+                score = -find_best_turns_rec(next, !color, depth + 1, -b, -a);
+            undo_search_turn();
+            return score;
+        };
+
+        // O2: выборочность только в тихих позициях и вдали от доказанных выигрышей
+        const bool selective = selective_search && !has_beats && x == -1 && abs(alpha) < WIN_BOUND &&
+                               abs(beta) < WIN_BOUND;
+        int futility_score = INF;
+        if (selective && remaining == 1)
+        {
+            const int static_score = leaf_score(pos, color, turns_played);
+            if (static_score + FUTILITY_MARGIN <= alpha)
+                futility_score = static_score + FUTILITY_MARGIN;
+        }
+
+        // Перебираем все возможные ходы
+        for (size_t i = 0;; ++i)
+        {
+            if (i == current_turns.size())
+            {
+                if (!quiets_pending)
+                    break;
+                // ход из таблицы не дал отсечения: остальные тихие ходы в порядке генератора
+                gen::generate_quiets(pos, color, current_turns);
+                current_turns.erase(remove(current_turns.begin() + 1, current_turns.end(), current_turns[0]),
+                                    current_turns.end());
+                quiets_pending = false;
+                if (i == current_turns.size())
+                    break;
+            }
+            const move_pos &turn = current_turns[i];
+            int score;
+
+            if (!selective || i == 0)
+            {
+                score = search_turn(turn, alpha, beta);
+            }
+            else if (gen::promotes(pos, turn))
+            {
+                // превращение в дамку меняет оценку сильнее запаса, такие ходы ищутся полностью
+                score = search_turn(turn, alpha, beta);
+            }
+            else if (futility_score != INF)
+            {
+                // тихий ход у листьев не поднимет оценку выше futility_score
+                score = futility_score;
+            }
+            else
+            {
+                // поздние ходы ищутся с нулевым окном и сокращением, если ход не отдает фигуру под взятие;
+                // если ход оказался лучше alpha, он ищется заново без сокращения и в полном окне
+                const int r = remaining >= LMR_MIN_REMAINING && i >= LMR_MOVES &&
+                                      !gen::has_captures(gen::apply(pos, turn), !color)
+                                  ? 1
+                                  : 0;
+                reduction += r;
+                score = search_turn(turn, alpha, alpha + 1);
+                reduction -= r;
+                if (r && score > alpha)
+                    score = search_turn(turn, alpha, alpha + 1);
+                if (score > alpha && score < beta)
+                    score = search_turn(turn, alpha, beta);
+            }
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_turn = turn;
+            }
+            alpha = max(alpha, score);
+
+            // Alpha-beta отсечение
+            if (pruning && alpha >= beta)
+                break;
+        }
+
+        // Ничья в ветке из-за позиции до узла (в пути или партии) делает оценку зависящей от пути к узлу.
+        // В таблицу, которую видят другие пути, партии и процессы, такой узел идет только ходом с глубиной 0:
+        // ход упорядочивает перебор, но не завершает узел
+        const bool path_dependent = draw_reach < int(ply);
+        draw_reach = min(draw_reach, outer_draw_reach);
+        if (path_dependent)
+        {
+            tt.store(key, best_turn, 0, 0, TT_UPPER);
+            return best_score;
+        }
+        const int8_t bound = best_score <= alpha_orig ? TT_UPPER : best_score >= beta ? TT_LOWER : TT_EXACT;
+        tt.store(key, best_turn, remaining, score_to_tt(best_score, turns_played), bound);
+        return best_score;
+    }
+
+
+public:
+    // Основная функция для поиска всех ходов на доске: ходы стороны color, при наличии взятий - только взятия
+    void find_turns(const bool color, const vector<vector<POS_T>>& mtx) override
+    {
+        have_beats = gen::generate(position::from_mtx(mtx), color, turns);
+    }
+
+    // Функция для поиска ходов для одной конкретной клетки (x, y)
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>>& mtx) override
+    {
+        have_beats = gen::generate_from(position::from_mtx(mtx), geo::square(x, y), turns);
+    }
+
+private:
+    // Отпечаток всего, от чего зависят оценки в таблице: размер доски, правила, веса и сеть оценки (FNV-1a)
+    uint64_t cache_fingerprint() const
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        auto mix = [&](const void *data, const size_t size) {
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= ((const uint8_t *)data)[i];
+                hash *= 0x100000001B3ull;
+            }
+        };
+        const int size = N;
+        mix(&size, sizeof(size));
+        mix(Rules::NAME, strlen(Rules::NAME));
+        const double w[] = {weights.man, weights.king, weights.advance, weights.center, weights.back_rank};
+        mix(w, sizeof(w));
+        if (nnue)
+        {
+            mix(nnue->l1_w, sizeof(nnue->l1_w));
+            mix(nnue->l1_b, sizeof(nnue->l1_b));
+            mix(nnue->l2_w, sizeof(nnue->l2_w));
+            mix(nnue->l2_b, sizeof(nnue->l2_b));
+            mix(nnue->out_w, sizeof(nnue->out_w));
+            mix(&nnue->out_b, sizeof(nnue->out_b));
+        }
+        return hash;
+    }
+
+    // Глубина текущей итерации поиска (от 0 до Max_depth)
+    int search_depth = 0;
+    // Сокращение глубины текущей ветки выборочным поиском O2
+    int reduction = 0;
+    // Таблица транспозиций, сохраняется между ходами; своя или общая с другими процессами (tt_shared)
+    transposition_table tt;
+    // Хеши расстановки по уровням текущей ветки поиска и число обратимых ходов подряд до каждого уровня
+    vector<uint64_t> hash_stack = vector<uint64_t>(1);
+    vector<int> quiet_stack = vector<int>(1);
+    // Хеши позиций партии из history, последняя - за ход до корня
+    vector<uint64_t> game_hashes;
+    // Генератор случайных чисел, используется для перемешивания ходов, а также для случайного выбора ходов
+    default_random_engine rand_eng;
+    unsigned seed = 0;
+    bool randomize = true;
+    int random_margin = 0;
+    // Веса оценки позиции: встроенные для BotScoringType или загруженные из файла EvalWeights
+    eval_weights weights;
+    // Нейросеть оценки (BotScoringType "NNUE"), nullptr для оценки по весам
+    shared_ptr<const nnue_network> nnue;
+    // Аккумуляторы нейросети по уровням текущей ветки поиска и текущий уровень
+    vector<nnue_accumulator> acc_stack = vector<nnue_accumulator>(1);
+    size_t ply = 0;
+    // Наименьший уровень, к которому отсылали ничьи rule_draw в переборе текущего узла (INT_MAX - не было)
+    int draw_reach = INT_MAX;
+    // Оптимизация поиска (Optimization): O0 - полный перебор, O1 - отсечения без потери точности,
+    // O2 - еще и выборочный поиск
+    bool pruning = true;
+    bool selective_search = false;
+};
+
+// Логика по русским правилам для доски 8 x 8 и 10 x 10
+using Logic8 = BoardLogic<8>;
+using Logic10 = BoardLogic<10>;
+
+template <int N, class Rules> class MctsLogic;
+
+// Логика с правилами settings.rules ("Russian", "English" или "Brazilian") для доски N x N:
+// альфа-бета или, если settings.engine == "MCTS", поиск Монте-Карло
+template <int N = 8> unique_ptr<Logic> make_logic(const logic_settings &settings)
+{
+    if (settings.engine != "Minimax" && settings.engine != "MCTS")
+        throw runtime_error("unknown engine " + settings.engine + " (expected Minimax or MCTS)");
+    return visit_rules(settings.rules, [&](auto rules) -> unique_ptr<Logic> {
+        if (settings.engine == "MCTS")
+            return make_unique<MctsLogic<N, decltype(rules)>>(settings);
+        return make_unique<BoardLogic<N, decltype(rules)>>(settings);
+    });
+}
+
+// Мульти-PV с ограничением: уровень level или, если time_ms > 0, уровни с 0 до level, пока не пройдет time_ms.
+// По времени каждый уровень ищется с нуля заново, таблица транспозиций сохраняет работу прошлых уровней
+inline vector<analysis_line> find_best_lines_limited(Logic &logic, const bool color, const vector<vector<POS_T>> &mtx,
+                                                     const size_t count, const int level, const int time_ms)
+{
+    const auto start = chrono::steady_clock::now();
+    vector<analysis_line> lines;
+    for (int l = time_ms > 0 ? 0 : level; l <= level; ++l)
+    {
+        logic.Max_depth = l;
+        lines = logic.find_best_lines(color, mtx, count);
+        if (chrono::steady_clock::now() - start >= chrono::milliseconds(time_ms))
+            break;
+    }
+    return lines;
+}
+
+#include "Mcts.h"
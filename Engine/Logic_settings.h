@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Настройки бота, которые раньше Logic читал напрямую из Config.
+// GUI заполняет их из settings.json (Config::get_logic_settings), CLI и бенчмарк - из аргументов командной строки.
+struct logic_settings
+{
+    std::string rules = "Russian";                   // "Russian", "English" или "Brazilian" (см. Rules.h)
+    std::string scoring_mode = "NumberAndPotential"; // "NumberOnly", "NumberAndPotential" или "NNUE"
+    std::string optimization = "O1";                 // "O0", "O1" (без потери точности) или "O2" (выборочный
+                                                     // поиск: меняет число узлов и может изменить выбор хода)
+    bool no_random = false;                          // детерминированный бот
+    unsigned seed = 0;                               // зерно случайного выбора хода, 0 - от текущего времени
+    int random_margin = 10;                          // случайный ход выбирается среди уступающих лучшему не больше
+    std::string weights_path;                        // файл весов оценки, пустая строка - веса по scoring_mode
+    std::string nnue_path;                           // файл нейросети для scoring_mode "NNUE"
+    size_t tt_size_mb = 16;                          // размер таблицы транспозиций в мегабайтах
+    std::string tt_shared;                           // имя общей таблицы в памяти для нескольких процессов, "" - своя
+    std::string engine = "Minimax";                  // "Minimax" (альфа-бета) или "MCTS" (см. Mcts.h)
+    int mcts_time_ms = 0;                            // время MCTS на ход, 0 - без ограничения по времени
+    size_t mcts_playouts = 0;                        // доигрываний MCTS на ход, 0 - без ограничения по числу
+    unsigned mcts_threads = 0;                       // потоки MCTS, 0 - по числу ядер
+    size_t mcts_pool_mb = 64;                        // пул узлов дерева MCTS в мегабайтах
+    double mcts_exploration = 1.0;                   // коэффициент исследования в формуле UCT
+    std::string cache_path;                          // файл таблицы транспозиций между запусками, пустая строка - без него
+
+    bool operator==(const logic_settings &other) const
+    {
+        return rules == other.rules && scoring_mode == other.scoring_mode && optimization == other.optimization &&
+               no_random == other.no_random && seed == other.seed && random_margin == other.random_margin &&
+               weights_path == other.weights_path && nnue_path == other.nnue_path && tt_size_mb == other.tt_size_mb &&
+               tt_shared == other.tt_shared && engine == other.engine && mcts_time_ms == other.mcts_time_ms &&
+               mcts_playouts == other.mcts_playouts && mcts_threads == other.mcts_threads &&
+               mcts_pool_mb == other.mcts_pool_mb && mcts_exploration == other.mcts_exploration &&
+               cache_path == other.cache_path;
+    }
+
+    bool operator!=(const logic_settings &other) const
+    {
+        return !(*this == other);
+    }
+};
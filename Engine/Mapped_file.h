@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Файл, отображенный в память только для чтения. На Windows файл читается целиком в буфер.
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    bool open(const string &path)
+    {
+        close();
+#ifndef _WIN32
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *ptr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            return false;
+        bytes = (const uint8_t *)ptr;
+        length = size_t(st.st_size);
+        mapped = true;
+#else
+        ifstream fin(path, ios::binary | ios::ate);
+        if (!fin)
+            return false;
+        buffer.resize(size_t(fin.tellg()));
+        fin.seekg(0);
+        if (buffer.empty() || !fin.read((char *)buffer.data(), buffer.size()))
+            return false;
+        bytes = buffer.data();
+        length = buffer.size();
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap((void *)bytes, length);
+#endif
+        mapped = false;
+        buffer.clear();
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const uint8_t *data() const
+    {
+        return bytes;
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+  private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    vector<uint8_t> buffer;
+};
@@ -0,0 +1,504 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Logic.h"
+
+using namespace std;
+
+// Бот поиском по дереву Монте-Карло (Bot.Engine "MCTS"). Все потоки строят одно дерево (tree-parallel):
+// спускаются по UCT, раскрывают лист, доигрывают короткую случайную партию и распространяют результат к корню.
+// Пока поток идет по узлу, на узле висит виртуальный проигрыш, и другие потоки выбирают соседние ветки.
+// Поиск ограничен временем и/или числом доигрываний, лучший ход - самый посещенный ребенок корня.
+// Общее дерево зависит от того, как чередуются потоки, поэтому с заданным Seed поиск строит MCTS_SEEDED_TREES
+// независимых деревьев (root-parallel): у каждого свой генератор и своя доля доигрываний, потоки берут деревья
+// по очереди, посещения детей корня складываются. Результат не зависит ни от числа потоков, ни от их скорости,
+// если бюджет задан числом доигрываний, а не временем.
+// Доигрывание длится не больше MCTS_ROLLOUT_PLIES ходов, затем позиция оценивается calc_score
+// и оценка переводится в вероятность выигрыша: 1 / (1 + exp(-score / SCORE_SCALE)).
+const int MCTS_ROLLOUT_PLIES = 12;
+// Без ограничений по времени и доигрываниям бюджет - столько доигрываний на уровень бота (Max_depth + 1)
+const size_t MCTS_PLAYOUTS_PER_LEVEL = 2000;
+// Результаты хранятся в узлах целыми числами: MCTS_VALUE_SCALE - выигрыш
+const int64_t MCTS_VALUE_SCALE = 1000000;
+// Независимых деревьев поиска с заданным Seed; пул узлов делится между ними поровну
+const unsigned MCTS_SEEDED_TREES = 4;
+
+// Узел дерева: позиция после хода, который ведет в узел. Дети узла лежат в пуле подряд с first_child
+template <int N> struct mcts_node
+{
+    bit_position<N> pos;
+    uint32_t first_child = 0;
+    uint16_t child_count = 0;
+    bool color = false;             // сторона хода в узле
+    atomic<uint8_t> state{0};       // 0 - не раскрыт, 1 - раскрывается другим потоком, 2 - раскрыт
+    atomic<int32_t> visits{0};
+    atomic<int32_t> virtual_loss{0};
+    atomic<int64_t> value{0};       // сумма результатов для стороны, сделавшей ход в узел
+
+    void reset(const bit_position<N> &p, const bool c)
+    {
+        pos = p;
+        color = c;
+        first_child = 0;
+        child_count = 0;
+        state.store(0, memory_order_relaxed);
+        visits.store(0, memory_order_relaxed);
+        virtual_loss.store(0, memory_order_relaxed);
+        value.store(0, memory_order_relaxed);
+    }
+};
+
+// Пул узлов: память выделяется один раз, узлы раздаются блоками сдвигом атомарного счетчика без блокировок.
+// Дерево каждого поиска строится заново с начала пула; когда пул заполнен, листья больше не раскрываются
+template <int N> class mcts_pool
+{
+  public:
+    // Доля 1 / parts от size_mb мегабайт
+    void resize(const size_t size_mb, const size_t parts = 1)
+    {
+        capacity = max<size_t>(size_mb * 1024 * 1024 / parts / sizeof(mcts_node<N>), 2);
+        nodes.reset();
+    }
+
+    void clear()
+    {
+        if (!nodes)
+            nodes.reset(new mcts_node<N>[capacity]);
+        used.store(0, memory_order_relaxed);
+    }
+
+    // Первый из count узлов подряд или UINT32_MAX, если места нет
+    uint32_t allocate(const size_t count)
+    {
+        const size_t first = used.fetch_add(count, memory_order_relaxed);
+        return first + count <= capacity ? uint32_t(first) : UINT32_MAX;
+    }
+
+    mcts_node<N> &operator[](const uint32_t index)
+    {
+        return nodes[index];
+    }
+
+    size_t size() const
+    {
+        return min(used.load(memory_order_relaxed), capacity);
+    }
+
+  private:
+    unique_ptr<mcts_node<N>[]> nodes;
+    size_t capacity = 2;
+    atomic<size_t> used{0};
+};
+
+// Правила, ходы и оценку дает BoardLogic, сам поиск - свой. Max_depth задает бюджет, если в настройках нет
+// ни времени, ни числа доигрываний
+template <int N, class Rules> class MctsLogic final : public Logic
+{
+  public:
+    using geo = board_geometry<N>;
+    using position = bit_position<N>;
+    using gen = movegen<N, Rules>;
+    using node = mcts_node<N>;
+
+    MctsLogic(const logic_settings &settings) : base(base_settings(settings)), settings(settings)
+    {
+        set_seed(settings.seed);
+    }
+
+    vector<move_pos> find_best_turns(const bool color, const vector<vector<POS_T>> &mtx) override
+    {
+        auto lines = search(color, position::from_mtx(mtx), 1);
+        if (lines.empty())
+            return {};
+        score = lines[0].score;
+        return lines[0].turns;
+    }
+
+    // Ходы корня по убыванию числа посещений: оценка - логит доли выигрышей в шкале SCORE_SCALE,
+    // продолжение - самые посещенные ходы ниже по дереву
+    vector<analysis_line> find_best_lines(const bool color, const vector<vector<POS_T>> &mtx,
+                                          const size_t count) override
+    {
+        auto lines = search(color, position::from_mtx(mtx), count);
+        if (lines.size() > count)
+            lines.resize(count);
+        return lines;
+    }
+
+    // Доигрывания новой партии - снова с Seed, дерево строится заново на каждый ход
+    void new_game() override
+    {
+        base.new_game();
+        if (settings.seed)
+            seed = settings.seed;
+    }
+
+    // Число деревьев зависит от того, задан ли Seed; пулы пересоздаются, только если оно меняется
+    void set_seed(const unsigned new_seed) override
+    {
+        base.set_seed(new_seed);
+        settings.seed = new_seed;
+        seed = new_seed ? new_seed : unsigned(time(0));
+        const unsigned tree_count = new_seed ? MCTS_SEEDED_TREES : 1;
+        if (trees.size() == tree_count)
+            return;
+        trees.clear();
+        for (unsigned t = 0; t < tree_count; ++t)
+        {
+            trees.emplace_back(new mcts_pool<N>());
+            trees.back()->resize(settings.mcts_pool_mb, tree_count);
+        }
+    }
+
+    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const override
+    {
+        return base.make_turn(mtx, turn);
+    }
+
+    bool promotes(const vector<vector<POS_T>> &mtx, const move_pos &turn) const override
+    {
+        return base.promotes(mtx, turn);
+    }
+
+    bool continues_capture(const vector<vector<POS_T>> &mtx, const move_pos &turn) const override
+    {
+        return base.continues_capture(mtx, turn);
+    }
+
+    int calc_score(const vector<vector<POS_T>> &mtx, const bool color) const override
+    {
+        return base.calc_score(mtx, color);
+    }
+
+    void find_turns(const bool color, const vector<vector<POS_T>> &mtx) override
+    {
+        base.find_turns(color, mtx);
+        turns = base.turns;
+        have_beats = base.have_beats;
+    }
+
+    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx) override
+    {
+        base.find_turns(x, y, mtx);
+        turns = base.turns;
+        have_beats = base.have_beats;
+    }
+
+    vector<vector<move_pos>> find_all_turns(const bool color, const vector<vector<POS_T>> &mtx) const override
+    {
+        return base.find_all_turns(color, mtx);
+    }
+
+  private:
+    // Базовой логике таблица транспозиций не нужна: ее поиск не вызывается
+    static logic_settings base_settings(logic_settings settings)
+    {
+        settings.tt_size_mb = 0;
+        settings.tt_shared.clear();
+        settings.cache_path.clear();
+        return settings;
+    }
+
+    vector<analysis_line> search(const bool color, const position &root_pos, const size_t count)
+    {
+        // корень - первый узел каждого дерева
+        for (auto &tree : trees)
+        {
+            tree->clear();
+            (*tree)[tree->allocate(1)].reset(root_pos, color);
+            expand(*tree, (*tree)[0]);
+        }
+
+        size_t budget = settings.mcts_playouts;
+        if (!budget && settings.mcts_time_ms <= 0)
+            budget = MCTS_PLAYOUTS_PER_LEVEL * size_t(max(Max_depth, 0) + 1);
+        const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(max(settings.mcts_time_ms, 0));
+        const bool timed = settings.mcts_time_ms > 0;
+        // один ход - искать нечего
+        if ((*trees[0])[0].child_count == 1)
+            budget = 1;
+
+        atomic<size_t> playouts{0};
+        atomic<bool> done{false};
+        const unsigned thread_count =
+            settings.mcts_threads ? settings.mcts_threads : max(1u, thread::hardware_concurrency());
+        const unsigned tree_count = unsigned(trees.size());
+        auto shared_worker = [&](const unsigned index) {
+            mt19937 rng(seed + index);
+            vector<uint32_t> path;
+            while (!done.load(memory_order_relaxed))
+            {
+                // доигрывание занимается до начала, чтобы потоки не вышли за бюджет
+                if (budget && playouts.fetch_add(1, memory_order_relaxed) >= budget)
+                {
+                    playouts.fetch_sub(1, memory_order_relaxed);
+                    done = true;
+                    break;
+                }
+                playout(*trees[0], 0, path, rng);
+                if (!budget)
+                    playouts.fetch_add(1, memory_order_relaxed);
+                if (timed && chrono::steady_clock::now() >= deadline)
+                    done = true;
+            }
+        };
+        // поток index ведет деревья index, index + workers, ... по очереди по одному доигрыванию;
+        // дерево t делает свою долю бюджета своим генератором, сколько бы ни было потоков
+        const unsigned workers = tree_count == 1 ? thread_count : min(thread_count, tree_count);
+        auto tree_worker = [&](const unsigned index) {
+            vector<unsigned> own;
+            vector<mt19937> rngs;
+            vector<size_t> left;
+            for (unsigned t = index; t < tree_count; t += workers)
+            {
+                own.push_back(t);
+                rngs.emplace_back(seed + t);
+                left.push_back(budget / tree_count + (t < budget % tree_count));
+            }
+            vector<uint32_t> path;
+            for (bool progress = true; progress && !done.load(memory_order_relaxed);)
+            {
+                progress = false;
+                for (size_t k = 0; k < own.size() && !done.load(memory_order_relaxed); ++k)
+                {
+                    if (budget && !left[k])
+                        continue;
+                    playout(*trees[own[k]], 0, path, rngs[k]);
+                    playouts.fetch_add(1, memory_order_relaxed);
+                    left[k] -= budget ? 1 : 0;
+                    progress = true;
+                    if (timed && chrono::steady_clock::now() >= deadline)
+                        done = true;
+                }
+            }
+        };
+        auto worker = [&](const unsigned index) {
+            if (tree_count == 1)
+                shared_worker(index);
+            else
+                tree_worker(index);
+        };
+        vector<thread> threads;
+        for (unsigned t = 1; t < workers; ++t)
+            threads.emplace_back(worker, t);
+        worker(0);
+        for (auto &th : threads)
+            th.join();
+        // следующий поиск - с другими случайными доигрываниями
+        seed += tree_count == 1 ? thread_count : tree_count;
+        nodes = playouts;
+
+        return root_lines(count);
+    }
+
+    // Раскрывает узел: дети - позиции после каждого целого хода. Если раскрывает другой поток или пул заполнен,
+    // узел остается листом
+    bool expand(mcts_pool<N> &pool, node &n)
+    {
+        uint8_t expected = 0;
+        if (!n.state.compare_exchange_strong(expected, 1, memory_order_acquire))
+            return expected == 2;
+        vector<position> children;
+        gen::full_moves(n.pos, n.color, children);
+        const uint32_t first = children.empty() ? 0 : pool.allocate(children.size());
+        if (first == UINT32_MAX)
+        {
+            n.state.store(0, memory_order_release);
+            return false;
+        }
+        for (size_t i = 0; i < children.size(); ++i)
+            pool[first + uint32_t(i)].reset(children[i], !n.color);
+        n.first_child = first;
+        n.child_count = uint16_t(children.size());
+        n.state.store(2, memory_order_release);
+        return true;
+    }
+
+    // UCT с виртуальными проигрышами: они считаются посещениями без выигрыша
+    uint32_t select(mcts_pool<N> &pool, const node &n, mt19937 &rng) const
+    {
+        const double parent = max(1, n.visits.load(memory_order_relaxed) + n.virtual_loss.load(memory_order_relaxed));
+        const double log_parent = log(parent);
+        double best_score = -1;
+        uint32_t best = n.first_child;
+        for (uint32_t i = n.first_child; i < n.first_child + n.child_count; ++i)
+        {
+            const node &c = pool[i];
+            const int visits = c.visits.load(memory_order_relaxed) + c.virtual_loss.load(memory_order_relaxed);
+            // непосещенные дети - первыми, в случайном порядке
+            double score = 1e9 + rng() % 1024;
+            if (visits > 0)
+                score = double(c.value.load(memory_order_relaxed)) / MCTS_VALUE_SCALE / visits +
+                        settings.mcts_exploration * sqrt(log_parent / visits);
+            if (score > best_score)
+            {
+                best_score = score;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Одно доигрывание: спуск по дереву, раскрытие листа, случайная партия и обновление узлов пути
+    void playout(mcts_pool<N> &pool, const uint32_t root, vector<uint32_t> &path, mt19937 &rng)
+    {
+        path.clear();
+        uint32_t current = root;
+        while (true)
+        {
+            node &n = pool[current];
+            path.push_back(current);
+            n.virtual_loss.fetch_add(1, memory_order_relaxed);
+            uint8_t state = n.state.load(memory_order_acquire);
+            // лист раскрывается со второго посещения, чтобы не тратить пул на узлы, куда поиск не вернется
+            if (state != 2 && n.visits.load(memory_order_relaxed) > 0 && expand(pool, n))
+                state = 2;
+            if (state != 2 || n.child_count == 0)
+                break;
+            current = select(pool, n, rng);
+        }
+
+        const node &leaf = pool[path.back()];
+        // вероятность выигрыша стороны, которая ходит в листе
+        double win = leaf.state.load(memory_order_acquire) == 2 && leaf.child_count == 0 ? 0.0
+                                                                                          : rollout(leaf.pos, leaf.color, rng);
+        for (size_t i = path.size(); i-- > 0;)
+        {
+            node &n = pool[path[i]];
+            // значение узла - для стороны, сделавшей ход в него
+            n.value.fetch_add(llround((1 - win) * MCTS_VALUE_SCALE), memory_order_relaxed);
+            n.visits.fetch_add(1, memory_order_relaxed);
+            n.virtual_loss.fetch_sub(1, memory_order_relaxed);
+            win = 1 - win;
+        }
+    }
+
+    // Случайная партия на MCTS_ROLLOUT_PLIES ходов (взятия обязательны и так) и вероятность выигрыша color
+    double rollout(position pos, const bool color, mt19937 &rng) const
+    {
+        bool side = color;
+        vector<move_pos> steps;
+        for (int ply = 0; ply < MCTS_ROLLOUT_PLIES; ++ply)
+        {
+            bool beats = gen::generate(pos, side, steps);
+            if (steps.empty())
+                return side == color ? 0.0 : 1.0;
+            move_pos turn = steps[rng() % steps.size()];
+            while (true)
+            {
+                const bool continues = beats && gen::continues_capture(pos, turn);
+                pos = gen::apply(pos, turn);
+                if (!continues || !(beats = gen::generate_from(pos, geo::square(turn.x2, turn.y2), steps)))
+                    break;
+                turn = steps[rng() % steps.size()];
+            }
+            side = !side;
+        }
+        const int score = base.calc_score(pos, color);
+        return 1 / (1 + exp(-double(score) / SCORE_SCALE));
+    }
+
+    // Варианты корня по убыванию посещений, сложенных по всем деревьям (дети корня в каждом дереве в одном порядке)
+    vector<analysis_line> root_lines(const size_t count)
+    {
+        const node &r = (*trees[0])[0];
+        vector<position> positions;
+        vector<vector<move_pos>> moves;
+        gen::full_moves(r.pos, r.color, positions, &moves);
+
+        vector<int> visits(r.child_count, 0);
+        vector<int64_t> values(r.child_count, 0);
+        for (auto &tree : trees)
+        {
+            const node &root = (*tree)[0];
+            for (uint32_t i = 0; i < root.child_count; ++i)
+            {
+                const node &c = (*tree)[root.first_child + i];
+                visits[i] += c.visits.load();
+                values[i] += c.value.load();
+            }
+        }
+        vector<pair<int, uint32_t>> order;
+        for (uint32_t i = 0; i < r.child_count; ++i)
+            order.emplace_back(visits[i], i);
+        stable_sort(order.begin(), order.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+        vector<analysis_line> lines;
+        for (size_t k = 0; k < order.size(); ++k)
+        {
+            const uint32_t i = order[k].second;
+            analysis_line line;
+            line.turns = moves[i];
+            line.score = node_score(positions[i], !r.color, visits[i], values[i]);
+            // продолжения нужны только для показанных вариантов: по дереву, где ход посещали больше всего
+            if (k < count)
+            {
+                mcts_pool<N> *best = trees[0].get();
+                for (auto &tree : trees)
+                    if ((*tree)[(*tree)[0].first_child + i].visits.load() >
+                        (*best)[(*best)[0].first_child + i].visits.load())
+                        best = tree.get();
+                line.pv = principal_variation(*best, (*best)[0].first_child + i);
+            }
+            line.depth = int(line.pv.size());
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    // Оценка хода в позицию pos (ходит color) для стороны, которая его сделала: у соперника нет ходов - выигрыш,
+    // иначе логит доли выигрышей
+    int node_score(const position &pos, const bool color, const int visits, const int64_t value) const
+    {
+        vector<move_pos> steps;
+        gen::generate(pos, color, steps);
+        if (steps.empty())
+            return WIN_SCORE - 1;
+        if (!visits)
+            return 0;
+        const double q = min(max(double(value) / MCTS_VALUE_SCALE / visits, 1e-6), 1 - 1e-6);
+        return int(lround(SCORE_SCALE * log(q / (1 - q))));
+    }
+
+    // Самые посещенные ходы от узла вниз, пока у детей есть посещения
+    vector<vector<move_pos>> principal_variation(mcts_pool<N> &pool, uint32_t index)
+    {
+        vector<vector<move_pos>> pv;
+        vector<position> positions;
+        vector<vector<move_pos>> moves;
+        while (pool[index].state.load() == 2 && pool[index].child_count > 0)
+        {
+            const node &n = pool[index];
+            uint32_t best = UINT32_MAX;
+            int best_visits = 0;
+            for (uint32_t i = 0; i < n.child_count; ++i)
+            {
+                const int visits = pool[n.first_child + i].visits.load();
+                if (visits > best_visits)
+                {
+                    best_visits = visits;
+                    best = i;
+                }
+            }
+            if (best == UINT32_MAX)
+                break;
+            moves.clear();
+            gen::full_moves(n.pos, n.color, positions, &moves);
+            pv.push_back(moves[best]);
+            index = n.first_child + best;
+        }
+        return pv;
+    }
+
+    BoardLogic<N, Rules> base;
+    logic_settings settings;
+    // одно общее дерево или MCTS_SEEDED_TREES независимых при заданном Seed
+    vector<unique_ptr<mcts_pool<N>>> trees;
+    unsigned seed;
+};
@@ -0,0 +1,388 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "Bitboard.h"
+#include "Rules.h"
+
+using namespace std;
+
+// Генератор ходов по маскам для доски N x N по правилам Rules (см. Rules.h).
+// Ход - один шаг move_pos; если continues_capture, серия взятий продолжается вызовом generate_from
+// для клетки, куда пришла фигура. Шаг применяется через apply: превращение в дамку зависит от правил.
+// Порядок ходов совпадает с прежним обходом матрицы: клетки по возрастанию номера, направления 0..3.
+// Поиск может генерировать ходы по стадиям: generate_captures, затем, если взятий нет, generate_quiets;
+// есть ли взятия, проверяется сдвигами масок без обхода фигур (capture_mask).
+template <int N, class Rules = russian_rules> struct movegen
+{
+    using geo = board_geometry<N>;
+    using mask_t = typename geo::mask_t;
+    using position = bit_position<N>;
+
+    // Все ходы стороны color; если есть взятия, возвращаются только они (результат true)
+    static bool generate(const position &pos, const bool color, vector<move_pos> &out)
+    {
+        if (generate_captures(pos, color, out))
+            return true;
+        generate_quiets(pos, color, out);
+        return false;
+    }
+
+    // Только взятия стороны color (out очищается); false - взятий нет, out пуст
+    static bool generate_captures(const position &pos, const bool color, vector<move_pos> &out)
+    {
+        out.clear();
+        for (mask_t rest = capture_mask(pos, color); rest; rest &= rest - 1)
+            captures(pos, lowest_bit(rest), color, out);
+        if (out.empty())
+            return false;
+        if constexpr (Rules::MAJORITY_CAPTURE)
+            keep_longest(pos, out);
+        return true;
+    }
+
+    // Тихие ходы стороны color дописываются в конец out (взятия не проверяются)
+    static void generate_quiets(const position &pos, const bool color, vector<move_pos> &out)
+    {
+        for (mask_t rest = pos.pieces(color); rest; rest &= rest - 1)
+            quiets(pos, lowest_bit(rest), color, out);
+    }
+
+    // Фигуры стороны color, которые могут бить. Шашки и недальнобойные дамки проверяются все сразу по направлениям:
+    // шаг маски на фигуру соперника и еще шаг на пустую клетку; дальнобойные дамки - по одной
+    static mask_t capture_mask(const position &pos, const bool color)
+    {
+        mask_t res = men_capture_mask(pos, color);
+        if constexpr (Rules::FLYING_KINGS)
+        {
+            for (mask_t rest = pos.kings[color]; rest; rest &= rest - 1)
+                if (can_capture(pos, lowest_bit(rest), color))
+                    res |= mask_t(1) << lowest_bit(rest);
+        }
+        return res;
+    }
+
+    // Есть ли у стороны color тихий ход
+    static bool has_quiets(const position &pos, const bool color)
+    {
+        const mask_t empty = ~pos.occupied();
+        const mask_t steppers = pos.men[color] | pos.kings[color];
+        for (int d = 0; d < 4; ++d)
+        {
+            // шашки ходят только вперед, дамки - во все стороны (дальнобойной достаточно соседней пустой клетки)
+            const mask_t movers = (color ? d >= 2 : d < 2) ? steppers : pos.kings[color];
+            if (step_mask<N>(movers, d) & empty)
+                return true;
+        }
+        return false;
+    }
+
+    // Является ли turn тихим ходом стороны color в позиции pos (ход из таблицы транспозиций до генерации)
+    static bool is_quiet(const position &pos, const bool color, const move_pos &turn)
+    {
+        if (turn.xb != -1 || turn.x < 0)
+            return false;
+        const int from = geo::square(turn.x, turn.y), to = geo::square(turn.x2, turn.y2);
+        if (!(pos.pieces(color) & (mask_t(1) << from)))
+            return false;
+        const auto &g = geometry<N>();
+        const mask_t occupied = pos.occupied();
+        const bool king = pos.kings[color] & (mask_t(1) << from);
+        for (int d = king || !color ? 0 : 2; d < (king || color ? 4 : 2); ++d)
+            for (int t = g.next[from][d]; t >= 0 && !(occupied & (mask_t(1) << t)); t = g.next[t][d])
+            {
+                if (t == to)
+                    return true;
+                if (!king || !Rules::FLYING_KINGS)
+                    break;
+            }
+        return false;
+    }
+
+    // Ходы фигуры на клетке s: взятия (результат true) или, если их нет, тихие ходы
+    static bool generate_from(const position &pos, const int s, vector<move_pos> &out)
+    {
+        out.clear();
+        const bool color = !(pos.pieces(0) & (mask_t(1) << s));
+        captures(pos, s, color, out);
+        if (!out.empty())
+        {
+            if constexpr (Rules::MAJORITY_CAPTURE)
+                keep_longest(pos, out);
+            return true;
+        }
+        quiets(pos, s, color, out);
+        return false;
+    }
+
+    // Становится ли шашка дамкой на шаге turn (pos - позиция до шага)
+    static bool promotes(const position &pos, const move_pos &turn)
+    {
+        const mask_t from = mask_t(1) << geo::square(turn.x, turn.y);
+        const int to = geo::square(turn.x2, turn.y2);
+        const bool color = !(pos.pieces(0) & from);
+        if (!(pos.men[color] & from) || !((mask_t(1) << to) & geometry<N>().promotion[color]))
+            return false;
+        if constexpr (Rules::PROMOTION == promotion_rule::end_of_capture)
+        {
+            if (turn.xb != -1)
+            {
+                position next = pos;
+                next.remove(geo::square(turn.xb, turn.yb));
+                next.men[color] ^= from | (mask_t(1) << to);
+                return !can_capture(next, to, color);
+            }
+        }
+        return true;
+    }
+
+    // Есть ли у стороны color хотя бы одно взятие
+    static bool has_captures(const position &pos, const bool color)
+    {
+        if (men_capture_mask(pos, color))
+            return true;
+        if constexpr (Rules::FLYING_KINGS)
+        {
+            for (mask_t rest = pos.kings[color]; rest; rest &= rest - 1)
+                if (can_capture(pos, lowest_bit(rest), color))
+                    return true;
+        }
+        return false;
+    }
+
+    // Продолжается ли ход той же фигурой после шага turn (pos - позиция до шага)
+    static bool continues_capture(const position &pos, const move_pos &turn)
+    {
+        if (turn.xb == -1)
+            return false;
+        if constexpr (Rules::PROMOTION == promotion_rule::continue_capture)
+            return true;
+        else
+            return !promotes(pos, turn);
+    }
+
+    // Позиция после шага turn
+    static position apply(position pos, const move_pos &turn)
+    {
+        if constexpr (Rules::PROMOTION == promotion_rule::continue_capture)
+        {
+            pos.apply(turn);
+        }
+        else
+        {
+            const bool man = (pos.men[0] | pos.men[1]) & (mask_t(1) << geo::square(turn.x, turn.y));
+            const bool promote = promotes(pos, turn);
+            pos.apply(turn);
+            // bit_position::apply превращает любую шашку на последней строке, здесь решают правила
+            if (man && !promote)
+                pos.demote(geo::square(turn.x2, turn.y2));
+        }
+        return pos;
+    }
+
+    // Позиции после каждого целого хода стороны color (серия взятий раскрывается в один ход) и, если moves
+    // не nullptr, сами ходы
+    static void full_moves(const position &pos, const bool color, vector<position> &out,
+                           vector<vector<move_pos>> *moves = nullptr)
+    {
+        out.clear();
+        vector<move_pos> steps;
+        const bool has_beats = generate(pos, color, steps);
+        vector<move_pos> path;
+        for (const auto &turn : steps)
+        {
+            path.assign(1, turn);
+            if (has_beats && continues_capture(pos, turn))
+                full_move_beats(apply(pos, turn), path, out, moves);
+            else
+            {
+                out.push_back(apply(pos, turn));
+                if (moves)
+                    moves->push_back(path);
+            }
+        }
+    }
+
+  private:
+    static void full_move_beats(const position &pos, vector<move_pos> &path, vector<position> &out,
+                                vector<vector<move_pos>> *moves)
+    {
+        vector<move_pos> steps;
+        if (!generate_from(pos, geo::square(path.back().x2, path.back().y2), steps))
+        {
+            out.push_back(pos);
+            if (moves)
+                moves->push_back(path);
+            return;
+        }
+        for (const auto &turn : steps)
+        {
+            path.push_back(turn);
+            if (continues_capture(pos, turn))
+                full_move_beats(apply(pos, turn), path, out, moves);
+            else
+            {
+                out.push_back(apply(pos, turn));
+                if (moves)
+                    moves->push_back(path);
+            }
+            path.pop_back();
+        }
+    }
+
+    static void emit(vector<move_pos> &out, const int from, const int to)
+    {
+        out.emplace_back(POS_T(geo::row(from)), POS_T(geo::col(from)), POS_T(geo::row(to)), POS_T(geo::col(to)));
+    }
+
+    static void emit(vector<move_pos> &out, const int from, const int to, const int beaten)
+    {
+        out.emplace_back(POS_T(geo::row(from)), POS_T(geo::col(from)), POS_T(geo::row(to)), POS_T(geo::col(to)),
+                         POS_T(geo::row(beaten)), POS_T(geo::col(beaten)));
+    }
+
+    // Направления взятия шашкой: все четыре или только вперед (белые - к строке 0, черные - к строке N - 1)
+    static constexpr int man_capture_begin(const bool color)
+    {
+        return Rules::MEN_CAPTURE_BACKWARD ? 0 : color ? 2 : 0;
+    }
+
+    static constexpr int man_capture_end(const bool color)
+    {
+        return Rules::MEN_CAPTURE_BACKWARD ? 4 : color ? 4 : 2;
+    }
+
+    // Шашки (и дамки, если они не дальнобойные), которые могут бить
+    static mask_t men_capture_mask(const position &pos, const bool color)
+    {
+        const mask_t empty = ~pos.occupied(), enemy = pos.pieces(!color);
+        const mask_t kings = Rules::FLYING_KINGS ? 0 : pos.kings[color];
+        mask_t res = 0;
+        for (int d = 0; d < 4; ++d)
+        {
+            const bool men_capture = d >= man_capture_begin(color) && d < man_capture_end(color);
+            const mask_t movers = men_capture ? pos.men[color] | kings : kings;
+            const mask_t victims = movers ? step_mask<N>(movers, d) & enemy : 0;
+            const mask_t landing = victims ? step_mask<N>(victims, d) & empty : 0;
+            // обратно по противоположному направлению 3 - d к фигурам, которые бьют
+            if (landing)
+                res |= step_mask<N>(step_mask<N>(landing, 3 - d), 3 - d);
+        }
+        return res;
+    }
+
+    // Может ли фигура на клетке s бить (то же, что captures, но без списка ходов)
+    static bool can_capture(const position &pos, const int s, const bool color)
+    {
+        const auto &g = geometry<N>();
+        const mask_t occupied = pos.occupied(), enemy = pos.pieces(!color);
+        const bool king = pos.kings[color] & (mask_t(1) << s);
+        for (int d = king ? 0 : man_capture_begin(color); d < (king ? 4 : man_capture_end(color)); ++d)
+        {
+            int b = g.next[s][d];
+            if (king && Rules::FLYING_KINGS)
+                while (b >= 0 && !(occupied & (mask_t(1) << b)))
+                    b = g.next[b][d];
+            if (b < 0 || !(enemy & (mask_t(1) << b)))
+                continue;
+            const int to = g.next[b][d];
+            if (to >= 0 && !(occupied & (mask_t(1) << to)))
+                return true;
+        }
+        return false;
+    }
+
+    static void captures(const position &pos, const int s, const bool color, vector<move_pos> &out)
+    {
+        const auto &g = geometry<N>();
+        const mask_t occupied = pos.occupied(), enemy = pos.pieces(!color);
+        const bool king = pos.kings[color] & (mask_t(1) << s);
+        if (!king || !Rules::FLYING_KINGS)
+        {
+            // шашка и недальнобойная дамка бьют соседнюю фигуру соперника, если за ней пусто
+            for (int d = king ? 0 : man_capture_begin(color); d < (king ? 4 : man_capture_end(color)); ++d)
+            {
+                const int b = g.next[s][d];
+                if (b < 0 || !(enemy & (mask_t(1) << b)))
+                    continue;
+                const int to = g.next[b][d];
+                if (to < 0 || (occupied & (mask_t(1) << to)))
+                    continue;
+                emit(out, s, to, b);
+            }
+            return;
+        }
+        // дамка: первая фигура на луче должна быть чужой, дальше - любые пустые клетки до следующей фигуры
+        for (int d = 0; d < 4; ++d)
+        {
+            int beaten = -1;
+            for (int t = g.next[s][d]; t >= 0; t = g.next[t][d])
+            {
+                const mask_t bit = mask_t(1) << t;
+                if (occupied & bit)
+                {
+                    if (beaten != -1 || !(enemy & bit))
+                        break;
+                    beaten = t;
+                }
+                else if (beaten != -1)
+                {
+                    emit(out, s, t, beaten);
+                }
+            }
+        }
+    }
+
+    static void quiets(const position &pos, const int s, const bool color, vector<move_pos> &out)
+    {
+        const auto &g = geometry<N>();
+        const mask_t occupied = pos.occupied();
+        const bool king = pos.kings[color] & (mask_t(1) << s);
+        if (!king || !Rules::FLYING_KINGS)
+        {
+            // белые шашки ходят к строке 0 (направления 0, 1), черные - к строке N - 1 (2, 3), дамка - во все стороны
+            for (int d = king || !color ? 0 : 2; d < (king || color ? 4 : 2); ++d)
+            {
+                const int to = g.next[s][d];
+                if (to >= 0 && !(occupied & (mask_t(1) << to)))
+                    emit(out, s, to);
+            }
+            return;
+        }
+        for (int d = 0; d < 4; ++d)
+            for (int t = g.next[s][d]; t >= 0 && !(occupied & (mask_t(1) << t)); t = g.next[t][d])
+                emit(out, s, t);
+    }
+
+    // Наибольшее число взятий, которое можно сделать после шага turn той же фигурой
+    static int longest_after(const position &pos, const move_pos &turn)
+    {
+        if (!continues_capture(pos, turn))
+            return 0;
+        const position next = apply(pos, turn);
+        vector<move_pos> steps;
+        captures(next, geo::square(turn.x2, turn.y2), !(pos.pieces(0) & (mask_t(1) << geo::square(turn.x, turn.y))),
+                 steps);
+        int best = 0;
+        for (const auto &step : steps)
+            best = max(best, 1 + longest_after(next, step));
+        return best;
+    }
+
+    // Правило большинства: остаются только шаги, начинающие серию с наибольшим числом взятий
+    static void keep_longest(const position &pos, vector<move_pos> &out)
+    {
+        vector<int> length(out.size());
+        int best = 0;
+        for (size_t i = 0; i < out.size(); ++i)
+        {
+            length[i] = longest_after(pos, out[i]);
+            best = max(best, length[i]);
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < out.size(); ++i)
+            if (length[i] == best)
+                out[kept++] = out[i];
+        out.erase(out.begin() + kept, out.end());
+    }
+};
@@ -0,0 +1,294 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include "../Models/Move.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+// Небольшая нейросеть оценки в стиле NNUE: 128 входов (32 темные клетки x 4 типа фигур) -> 64 -> 32 -> 1.
+// Первый слой хранится как аккумулятор int16 и обновляется по разнице фигур при каждом ходе,
+// остальные слои считаются в int8 (AVX2, SSSE3, SSE2 или обычный код, выбирается при компиляции через -march;
+// SSE2 есть на любом x86-64, поэтому сборка по умолчанию не скалярная).
+// Выход - логит результата с точки зрения белых.
+namespace nnue
+{
+const int INPUTS = 128;
+const int L1 = 64;
+const int L2 = 32;
+// Масштабы квантования: активации [0, 1] -> [0, 127], веса второго и выходного слоев x64
+const int ACT_SCALE = 127;
+const int WEIGHT_SCALE = 64;
+const int WEIGHT_SHIFT = 6;
+
+const uint32_t FILE_VERSION = 1;
+
+// Номер входа для фигуры type (1..4) на клетке (i, j)
+inline int feature(const POS_T i, const POS_T j, const POS_T type)
+{
+    return (type - 1) * 32 + i * 4 + j / 2;
+}
+} // namespace nnue
+
+struct nnue_network
+{
+    alignas(32) int16_t l1_w[nnue::INPUTS][nnue::L1];
+    alignas(32) int16_t l1_b[nnue::L1];
+    alignas(32) int8_t l2_w[nnue::L2][nnue::L1];
+    int32_t l2_b[nnue::L2];
+    alignas(32) int8_t out_w[nnue::L2];
+    int32_t out_b;
+
+    // Формат файла: "CKNN", версия, размеры слоев (uint32), затем массивы весов в порядке полей (little-endian)
+    bool load(const string &path)
+    {
+        ifstream fin(path, ios::binary);
+        char magic[4];
+        uint32_t header[4];
+        if (!fin.read(magic, 4) || memcmp(magic, "CKNN", 4) != 0 || !fin.read((char *)header, sizeof(header)))
+            return false;
+        if (header[0] != nnue::FILE_VERSION || header[1] != nnue::INPUTS || header[2] != nnue::L1 ||
+            header[3] != nnue::L2)
+            return false;
+        fin.read((char *)l1_w, sizeof(l1_w));
+        fin.read((char *)l1_b, sizeof(l1_b));
+        fin.read((char *)l2_w, sizeof(l2_w));
+        fin.read((char *)l2_b, sizeof(l2_b));
+        fin.read((char *)out_w, sizeof(out_w));
+        fin.read((char *)&out_b, sizeof(out_b));
+        return bool(fin);
+    }
+
+    bool save(const string &path) const
+    {
+        ofstream fout(path, ios::binary);
+        const uint32_t header[4] = {nnue::FILE_VERSION, nnue::INPUTS, nnue::L1, nnue::L2};
+        fout.write("CKNN", 4);
+        fout.write((const char *)header, sizeof(header));
+        fout.write((const char *)l1_w, sizeof(l1_w));
+        fout.write((const char *)l1_b, sizeof(l1_b));
+        fout.write((const char *)l2_w, sizeof(l2_w));
+        fout.write((const char *)l2_b, sizeof(l2_b));
+        fout.write((const char *)out_w, sizeof(out_w));
+        fout.write((const char *)&out_b, sizeof(out_b));
+        return bool(fout);
+    }
+
+    static const char *kernel_name()
+    {
+#if defined(__AVX2__)
+        return "avx2";
+#elif defined(__SSSE3__)
+        return "ssse3";
+#elif defined(__SSE2__) || defined(_M_X64)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+};
+
+// Аккумулятор первого слоя и количество фигур каждой стороны (для быстрых проверок на конец игры)
+struct nnue_accumulator
+{
+    alignas(32) int16_t v[nnue::L1];
+    int count[2]; // 0 - белые, 1 - черные
+
+    // Полный пересчет по доске
+    void refresh(const nnue_network &net, const vector<vector<POS_T>> &mtx)
+    {
+        memcpy(v, net.l1_b, sizeof(v));
+        count[0] = count[1] = 0;
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = (i + 1) % 2; j < 8; j += 2)
+            {
+                if (!mtx[i][j])
+                    continue;
+                add(net.l1_w[nnue::feature(i, j, mtx[i][j])]);
+                ++count[mtx[i][j] % 2 == 0];
+            }
+        }
+    }
+
+    // Полный пересчет по маскам позиции (номер клетки в маске совпадает с номером в nnue::feature)
+    void refresh(const nnue_network &net, const bit_position<8> &pos)
+    {
+        memcpy(v, net.l1_b, sizeof(v));
+        for (int c = 0; c < 2; ++c)
+        {
+            count[c] = bit_count(pos.pieces(c));
+            for (uint32_t rest = pos.men[c]; rest; rest &= rest - 1)
+                add(net.l1_w[c * 32 + lowest_bit(rest)]);
+            for (uint32_t rest = pos.kings[c]; rest; rest &= rest - 1)
+                add(net.l1_w[(2 + c) * 32 + lowest_bit(rest)]);
+        }
+    }
+
+    // Инкрементальное обновление по разнице позиций до и после шага; превращение в дамку по любым правилам
+    // видно по маскам само
+    void update(const nnue_network &net, const bit_position<8> &before, const bit_position<8> &after)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            for (uint32_t rest = before.men[c] ^ after.men[c]; rest; rest &= rest - 1)
+            {
+                const int s = lowest_bit(rest);
+                if (after.men[c] >> s & 1)
+                    add(net.l1_w[c * 32 + s]);
+                else
+                    sub(net.l1_w[c * 32 + s]);
+            }
+            for (uint32_t rest = before.kings[c] ^ after.kings[c]; rest; rest &= rest - 1)
+            {
+                const int s = lowest_bit(rest);
+                if (after.kings[c] >> s & 1)
+                    add(net.l1_w[(2 + c) * 32 + s]);
+                else
+                    sub(net.l1_w[(2 + c) * 32 + s]);
+            }
+            count[c] = bit_count(after.pieces(c));
+        }
+    }
+
+    // Выход сети (логит результата для белых)
+    double evaluate(const nnue_network &net) const
+    {
+        alignas(32) uint8_t h1[nnue::L1];
+        alignas(32) uint8_t h2[nnue::L2];
+        clipped_relu(h1);
+        for (int o = 0; o < nnue::L2; ++o)
+        {
+            const int32_t sum = (dot(h1, net.l2_w[o], nnue::L1) + net.l2_b[o]) >> nnue::WEIGHT_SHIFT;
+            h2[o] = uint8_t(sum < 0 ? 0 : sum > nnue::ACT_SCALE ? nnue::ACT_SCALE : sum);
+        }
+        const int32_t out = dot(h2, net.out_w, nnue::L2) + net.out_b;
+        return double(out) / (nnue::ACT_SCALE * nnue::WEIGHT_SCALE);
+    }
+
+  private:
+    void add(const int16_t *w)
+    {
+#if defined(__AVX2__)
+        for (int k = 0; k < nnue::L1; k += 16)
+        {
+            __m256i *dst = (__m256i *)(v + k);
+            _mm256_store_si256(dst, _mm256_add_epi16(_mm256_load_si256(dst), _mm256_load_si256((const __m256i *)(w + k))));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (int k = 0; k < nnue::L1; k += 8)
+        {
+            __m128i *dst = (__m128i *)(v + k);
+            _mm_store_si128(dst, _mm_add_epi16(_mm_load_si128(dst), _mm_load_si128((const __m128i *)(w + k))));
+        }
+#else
+        for (int k = 0; k < nnue::L1; ++k)
+            v[k] += w[k];
+#endif
+    }
+
+    void sub(const int16_t *w)
+    {
+#if defined(__AVX2__)
+        for (int k = 0; k < nnue::L1; k += 16)
+        {
+            __m256i *dst = (__m256i *)(v + k);
+            _mm256_store_si256(dst, _mm256_sub_epi16(_mm256_load_si256(dst), _mm256_load_si256((const __m256i *)(w + k))));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (int k = 0; k < nnue::L1; k += 8)
+        {
+            __m128i *dst = (__m128i *)(v + k);
+            _mm_store_si128(dst, _mm_sub_epi16(_mm_load_si128(dst), _mm_load_si128((const __m128i *)(w + k))));
+        }
+#else
+        for (int k = 0; k < nnue::L1; ++k)
+            v[k] -= w[k];
+#endif
+    }
+
+    // Ограничение аккумулятора отрезком [0, 127] и упаковка в uint8
+    void clipped_relu(uint8_t *out) const
+    {
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256(), top = _mm256_set1_epi16(nnue::ACT_SCALE);
+        for (int k = 0; k < nnue::L1; k += 32)
+        {
+            __m256i a = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i *)(v + k)), zero), top);
+            __m256i b = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i *)(v + k + 16)), zero), top);
+            // packus чередует 128-битные половины, permute возвращает исходный порядок
+            _mm256_store_si256((__m256i *)(out + k), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128i zero = _mm_setzero_si128(), top = _mm_set1_epi16(nnue::ACT_SCALE);
+        for (int k = 0; k < nnue::L1; k += 16)
+        {
+            __m128i a = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i *)(v + k)), zero), top);
+            __m128i b = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i *)(v + k + 8)), zero), top);
+            _mm_store_si128((__m128i *)(out + k), _mm_packus_epi16(a, b));
+        }
+#else
+        for (int k = 0; k < nnue::L1; ++k)
+            out[k] = uint8_t(v[k] < 0 ? 0 : v[k] > nnue::ACT_SCALE ? nnue::ACT_SCALE : v[k]);
+#endif
+    }
+
+    // Скалярное произведение uint8 x int8, n кратно 32
+    static int32_t dot(const uint8_t *a, const int8_t *b, const int n)
+    {
+#if defined(__AVX2__)
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < n; k += 32)
+        {
+            const __m256i prod = _mm256_maddubs_epi16(_mm256_load_si256((const __m256i *)(a + k)),
+                                                      _mm256_load_si256((const __m256i *)(b + k)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(prod, ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        return _mm_cvtsi128_si32(s);
+#elif defined(__SSSE3__)
+        const __m128i ones = _mm_set1_epi16(1);
+        __m128i sum = _mm_setzero_si128();
+        for (int k = 0; k < n; k += 16)
+        {
+            const __m128i prod =
+                _mm_maddubs_epi16(_mm_load_si128((const __m128i *)(a + k)), _mm_load_si128((const __m128i *)(b + k)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(prod, ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+#elif defined(__SSE2__) || defined(_M_X64)
+        // без maddubs: байты расширяются до int16 (a - нулями, b - знаком), пары перемножаются madd
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        for (int k = 0; k < n; k += 16)
+        {
+            const __m128i va = _mm_load_si128((const __m128i *)(a + k));
+            const __m128i vb = _mm_load_si128((const __m128i *)(b + k));
+            const __m128i sign = _mm_cmpgt_epi8(zero, vb);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, sign)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, sign)));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        return _mm_cvtsi128_si32(sum);
+#else
+        int32_t sum = 0;
+        for (int k = 0; k < n; ++k)
+            sum += int32_t(a[k]) * b[k];
+        return sum;
+#endif
+    }
+};
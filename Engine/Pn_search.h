@@ -0,0 +1,569 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Movegen.h"
+#include "Transposition.h"
+
+using namespace std;
+
+// Решатель: точный результат позиции поиском по числам доказательства в глубину (DF-PN) без оценочной функции.
+// Узел - позиция после целого хода (серия взятий - один ход). Для атакующей стороны доказывается выигрыш:
+// pn - сколько листьев еще нужно доказать, dn - сколько опровергнуть. Партия ограничена max_plies ходами
+// (как MaxNumTurns в игре и --max-turns в CLI: после них ничья), поэтому оставшееся число ходов входит в ключ
+// таблицы, и циклов по позициям нет. Ничья по числу обратимых ходов подряд (без взятий и ходов шашками,
+// 2 * QUIET_DRAW_MOVES по правилам) тоже считается: счетчик входит в ключ. Повторение позиций не учитывается -
+// оно зависит от пути к узлу. Результат стороны хода: выигрыш, если доказан ее выигрыш; проигрыш, если
+// доказан выигрыш соперника; ничья, если оба выигрыша опровергнуты.
+const int PN_UNKNOWN = 0, PN_WIN = 1, PN_LOSS = 2, PN_DRAW = 3;
+
+const uint32_t PN_INF = 0x7FFFFFFF;
+
+struct pn_settings
+{
+    int max_plies = 120;        // ходов до ничьей
+    int quiet_plies = 0;        // обратимых ходов подряд, сделанных до позиции
+    int quiet_limit = 0;        // ничья после стольких обратимых ходов подряд, 0 - 2 * QUIET_DRAW_MOVES правил
+    size_t tt_size_mb = 256;
+    unsigned threads = 0;       // 0 - по числу ядер
+    uint64_t max_nodes = 0;     // 0 - без ограничения
+    int time_ms = 0;            // 0 - без ограничения
+    string checkpoint_path;     // "" - без сохранения; если файл есть и подходит к позиции, решение продолжается с него
+    int checkpoint_sec = 60;    // как часто сохранять таблицу
+    double epsilon = 0.25;      // порог 1 + epsilon (Pawlewicz) уменьшает переключения между ветками
+};
+
+struct pn_solution
+{
+    int value = PN_UNKNOWN;     // с точки зрения стороны хода
+    vector<move_pos> best;      // выигрывающий ход для PN_WIN
+    uint32_t pn = 1, dn = 1;    // числа корня последней задачи (для PN_UNKNOWN - насколько далеко до ответа)
+    uint64_t nodes = 0;
+    size_t loaded = 0;          // записей, загруженных из контрольной точки
+    int checkpoint_failures = 0; // неудачных сохранений контрольной точки (решение при этом продолжается)
+    string checkpoint_error;    // причина последней неудачи
+};
+
+inline const char *pn_value_name(const int value)
+{
+    return value == PN_WIN ? "win" : value == PN_LOSS ? "loss" : value == PN_DRAW ? "draw" : "unknown";
+}
+
+// Запись таблицы решателя; busy - сколько потоков сейчас внутри узла, другие потоки его обходят
+struct pn_entry
+{
+    uint64_t key = 0;
+    uint32_t pn = 1, dn = 1;
+    uint32_t work = 0;          // размер поддерева (узлов), вытесняется запись с наименьшим
+    uint32_t busy = 0;
+};
+
+static_assert(sizeof(pn_entry) == 24, "pn entry must stay 24 bytes");
+
+// Общая таблица потоков: корзины по PN_WAYS записей, корзины защищены полосами мьютексов.
+// Размер ограничен, при нехватке места вытесняется запись с наименьшей работой.
+class pn_table
+{
+  public:
+    static constexpr size_t PN_WAYS = 4;
+    static constexpr size_t STRIPES = 4096;
+
+    void resize(const size_t size_mb)
+    {
+        size_t buckets = 1;
+        while (buckets * 2 * PN_WAYS * sizeof(pn_entry) <= size_mb * 1024 * 1024)
+            buckets *= 2;
+        entries.assign(buckets * PN_WAYS, pn_entry());
+        mask = buckets - 1;
+        locks.reset(new mutex[STRIPES]);
+    }
+
+    bool lookup(const uint64_t key, pn_entry &out) const
+    {
+        const size_t bucket = key & mask;
+        lock_guard<mutex> lock(locks[bucket % STRIPES]);
+        for (size_t w = 0; w < PN_WAYS; ++w)
+        {
+            const pn_entry &e = entries[bucket * PN_WAYS + w];
+            if (e.key == key)
+            {
+                out = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Записывает числа узла; busy_delta меняет счетчик потоков в узле
+    void store(const uint64_t key, const uint32_t pn, const uint32_t dn, const uint32_t work, const int busy_delta = 0)
+    {
+        const size_t bucket = key & mask;
+        lock_guard<mutex> lock(locks[bucket % STRIPES]);
+        pn_entry *slot = find_slot(bucket, key);
+        slot->pn = pn;
+        slot->dn = dn;
+        slot->work = max(slot->work, work);
+        slot->busy = uint32_t(max(0, int(slot->busy) + busy_delta));
+    }
+
+    // Поток вошел в узел: числа узла не меняются (новый узел - pn = dn = 1)
+    void enter(const uint64_t key)
+    {
+        const size_t bucket = key & mask;
+        lock_guard<mutex> lock(locks[bucket % STRIPES]);
+        ++find_slot(bucket, key)->busy;
+    }
+
+    // Непустые записи по полосам: каждая полоса копируется под своим мьютексом, пока потоки продолжают работу.
+    // Снимок не согласован между полосами, но решенные узлы верны всегда, а остальные числа - лишь подсказки
+    template <class F> void for_each_stripe(F &&f) const
+    {
+        vector<pn_entry> chunk;
+        for (size_t s = 0; s < STRIPES; ++s)
+        {
+            chunk.clear();
+            {
+                lock_guard<mutex> lock(locks[s]);
+                for (size_t bucket = s; bucket <= mask; bucket += STRIPES)
+                    for (size_t w = 0; w < PN_WAYS; ++w)
+                        if (entries[bucket * PN_WAYS + w].key)
+                            chunk.push_back(entries[bucket * PN_WAYS + w]);
+            }
+            for (auto &e : chunk)
+                e.busy = 0;
+            f(chunk);
+        }
+    }
+
+  private:
+    // Запись ключа в корзине или место для нее (вызывается под мьютексом полосы)
+    pn_entry *find_slot(const size_t bucket, const uint64_t key)
+    {
+        pn_entry *slot = nullptr;
+        for (size_t w = 0; w < PN_WAYS; ++w)
+        {
+            pn_entry &e = entries[bucket * PN_WAYS + w];
+            if (e.key == key)
+                return &e;
+            // решенные узлы и узлы, где работают потоки, вытесняются последними
+            if (!slot || rank(e) < rank(*slot))
+                slot = &e;
+        }
+        if (slot->key != key)
+        {
+            *slot = pn_entry();
+            slot->key = key;
+        }
+        return slot;
+    }
+
+    static uint64_t rank(const pn_entry &e)
+    {
+        if (!e.key)
+            return 0;
+        const bool solved = e.pn == 0 || e.dn == 0;
+        return uint64_t(e.work) + 1 + (solved ? uint64_t(1) << 32 : 0) + (e.busy ? uint64_t(1) << 33 : 0);
+    }
+
+    vector<pn_entry> entries;
+    size_t mask = 0;
+    unique_ptr<mutex[]> locks;
+};
+
+template <int N, class Rules = russian_rules> class pn_solver
+{
+  public:
+    using geo = board_geometry<N>;
+    using position = bit_position<N>;
+    using gen = movegen<N, Rules>;
+
+    // Заголовок контрольной точки, за ним count записей pn_entry
+    struct checkpoint_header
+    {
+        char magic[4];          // "CKPN"
+        uint32_t version;
+        uint32_t entry_size;
+        int32_t size;           // N
+        char rules[16];
+        uint64_t root;          // хеш позиции со стороной хода
+        int32_t max_plies;
+        uint16_t quiet_plies;
+        uint16_t quiet_limit;
+        uint64_t count;
+    };
+
+    static constexpr uint32_t CHECKPOINT_VERSION = 2;
+
+    pn_solver(const pn_settings &settings)
+        : settings(settings),
+          quiet_limit(settings.quiet_limit > 0 ? settings.quiet_limit : 2 * Rules::QUIET_DRAW_MOVES)
+    {
+        table.resize(settings.tt_size_mb);
+    }
+
+    // Точный результат позиции для стороны color. Решение останавливается по stop, max_nodes или time_ms
+    // с результатом PN_UNKNOWN; таблица при этом сохраняется в контрольную точку, и следующий запуск продолжит
+    pn_solution solve(const vector<vector<POS_T>> &mtx, const bool color, const atomic<bool> *stop = nullptr)
+    {
+        const position root = position::from_mtx(mtx);
+        const uint64_t root_hash = board_hash(root) ^ (color ? zobrist().side : 0);
+        pn_solution res;
+        if (!settings.checkpoint_path.empty())
+            res.loaded = load_checkpoint(root_hash);
+        checkpoint_failures = 0;
+        checkpoint_error.clear();
+
+        start = chrono::steady_clock::now();
+        last_checkpoint = start;
+        nodes = 0;
+        stop_all = false;
+        user_stop = stop;
+
+        // сначала выигрыш стороны хода; если он опровергнут - выигрыш соперника
+        pn_entry first = run(root, color, color, root_hash);
+        res.pn = first.pn;
+        res.dn = first.dn;
+        if (first.pn == 0)
+        {
+            res.value = PN_WIN;
+            res.best = winning_move(root, color);
+        }
+        else if (first.dn == 0)
+        {
+            pn_entry second = run(root, color, !color, root_hash);
+            res.pn = second.pn;
+            res.dn = second.dn;
+            res.value = second.pn == 0 ? PN_LOSS : second.dn == 0 ? PN_DRAW : PN_UNKNOWN;
+        }
+        res.nodes = nodes;
+        if (!settings.checkpoint_path.empty())
+            save_checkpoint(root_hash);
+        res.checkpoint_failures = checkpoint_failures;
+        res.checkpoint_error = checkpoint_error;
+        return res;
+    }
+
+  private:
+    struct child
+    {
+        position pos;
+        int quiet;
+        uint64_t key;
+    };
+
+    // Ключ узла: расстановка, сторона хода, атакующая сторона, число оставшихся ходов и обратимых ходов подряд
+    static uint64_t node_key(const uint64_t board, const bool color, const bool attacker, const int remaining,
+                             const int quiet)
+    {
+        uint64_t x = (uint64_t(quiet) << 32 | uint64_t(remaining) << 1 | attacker) + 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        const uint64_t key = board ^ (color ? zobrist().side : 0) ^ x;
+        return key ? key : 1;
+    }
+
+    // Обратимых ходов подряд после хода из pos в next: взятие или ход шашкой (и превращение) обнуляет счет
+    static int next_quiet(const position &pos, const position &next, const int quiet)
+    {
+        const bool reversible = next.men[0] == pos.men[0] && next.men[1] == pos.men[1] &&
+                                bit_count(next.occupied()) == bit_count(pos.occupied());
+        return reversible ? quiet + 1 : 0;
+    }
+
+    int root_quiet() const
+    {
+        return min(max(settings.quiet_plies, 0), quiet_limit);
+    }
+
+    // Одна задача: все потоки ищут от корня с общей таблицей, пока корень не решен или не пора остановиться
+    pn_entry run(const position &root, const bool color, const bool attacker, const uint64_t root_hash)
+    {
+        const uint64_t key = node_key(board_hash(root), color, attacker, settings.max_plies, root_quiet());
+        pn_entry entry;
+        if (table.lookup(key, entry) && (entry.pn == 0 || entry.dn == 0))
+            return entry;
+
+        stop_all = false;
+        const unsigned threads = settings.threads ? settings.threads : max(1u, thread::hardware_concurrency());
+        auto worker = [&]() {
+            worker_state state;
+            state.attacker = attacker;
+            while (!stop_all)
+            {
+                mid(state, root, color, settings.max_plies, root_quiet(), key, PN_INF, PN_INF);
+                pn_entry e;
+                if (table.lookup(key, e) && (e.pn == 0 || e.dn == 0))
+                    stop_workers();
+            }
+            nodes += state.local_nodes;
+        };
+        vector<thread> pool;
+        for (unsigned t = 0; t < threads; ++t)
+            pool.emplace_back(worker);
+
+        // этот поток следит за ограничениями и сохраняет контрольные точки; решенный корень будит его сразу.
+        // Неудачная запись не останавливает решение: попытка повторится через checkpoint_sec
+        while (!stop_all)
+        {
+            {
+                unique_lock<mutex> lock(stop_mutex);
+                stop_cv.wait_for(lock, chrono::milliseconds(20), [&]() { return stop_all.load(); });
+            }
+            const auto now = chrono::steady_clock::now();
+            if ((user_stop && *user_stop) || (settings.max_nodes && nodes + pending_nodes >= settings.max_nodes) ||
+                (settings.time_ms > 0 && now - start >= chrono::milliseconds(settings.time_ms)))
+                stop_all = true;
+            else if (!settings.checkpoint_path.empty() && settings.checkpoint_sec > 0 &&
+                     now - last_checkpoint >= chrono::seconds(settings.checkpoint_sec))
+            {
+                save_checkpoint(root_hash);
+                last_checkpoint = chrono::steady_clock::now();
+            }
+        }
+        for (auto &th : pool)
+            th.join();
+        pending_nodes = 0;
+        if (!table.lookup(key, entry))
+            entry = pn_entry();
+        return entry;
+    }
+
+    struct worker_state
+    {
+        bool attacker = false;
+        uint64_t local_nodes = 0;
+    };
+
+    void stop_workers()
+    {
+        {
+            lock_guard<mutex> lock(stop_mutex);
+            stop_all = true;
+        }
+        stop_cv.notify_all();
+    }
+
+    static uint32_t saturated(const uint64_t value)
+    {
+        return uint32_t(min<uint64_t>(value, PN_INF - 1));
+    }
+
+    // Порог 1 + epsilon для второго по величине числа
+    uint32_t widen(const uint32_t second) const
+    {
+        if (second >= PN_INF - 1)
+            return second;
+        return saturated(max<uint64_t>(uint64_t(second) + 1, uint64_t(ceil(second * (1 + settings.epsilon)))));
+    }
+
+    // Поиск в узле, пока его числа ниже порогов thpn и thdn (Nagai). Числа узла сохраняются в таблице
+    pn_entry mid(worker_state &state, const position &pos, const bool color, const int remaining, const int quiet,
+                 const uint64_t key, const uint32_t thpn, const uint32_t thdn)
+    {
+        if (++state.local_nodes % 1024 == 0)
+        {
+            pending_nodes += 1024;
+            if (settings.max_nodes && nodes + pending_nodes >= settings.max_nodes)
+                stop_workers();
+        }
+        const bool or_node = color == state.attacker;
+        pn_entry res;
+        res.key = key;
+
+        vector<position> positions;
+        const bool rule_draw = remaining == 0 || quiet >= quiet_limit;
+        if (!rule_draw)
+            gen::full_moves(pos, color, positions);
+        // ходов нет - сторона хода проиграла; ходы кончились или ничья по обратимым ходам - выигрыш не доказан
+        if (positions.empty() || rule_draw)
+        {
+            const bool attacker_wins = positions.empty() && !rule_draw && !or_node;
+            res.pn = attacker_wins ? 0 : PN_INF;
+            res.dn = attacker_wins ? PN_INF : 0;
+            table.store(key, res.pn, res.dn, 1);
+            return res;
+        }
+
+        vector<child> kids(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            const int kid_quiet = next_quiet(pos, positions[i], quiet);
+            kids[i] = child{positions[i], kid_quiet,
+                            node_key(board_hash(positions[i]), !color, state.attacker, remaining - 1, kid_quiet)};
+        }
+
+        const uint64_t nodes_before = state.local_nodes;
+        table.enter(key);
+        while (true)
+        {
+            // числа узла по детям; best - ребенок с наименьшим числом с учетом потоков в нем
+            uint64_t sum = 0;
+            uint32_t best_value = PN_INF, second = PN_INF, min_value = PN_INF;
+            uint64_t best_rank = UINT64_MAX;
+            size_t best = 0;
+            pn_entry best_entry;
+            for (size_t i = 0; i < kids.size(); ++i)
+            {
+                pn_entry e;
+                if (!table.lookup(kids[i].key, e))
+                    e = pn_entry();
+                // у узла ИЛИ выбираем ребенка с наименьшим pn, у узла И - с наименьшим dn
+                const uint32_t select = or_node ? e.pn : e.dn;
+                const uint32_t other = or_node ? e.dn : e.pn;
+                sum = other == PN_INF || sum == PN_INF ? PN_INF : sum + other;
+                min_value = min(min_value, select);
+                const uint64_t rank = uint64_t(select) * (1 + e.busy);
+                if (rank < best_rank)
+                {
+                    if (best_rank != UINT64_MAX)
+                        second = min(second, best_value);
+                    best_rank = rank;
+                    best_value = select;
+                    best = i;
+                    best_entry = e;
+                }
+                else
+                {
+                    second = min(second, select);
+                }
+            }
+            const uint32_t total = sum == PN_INF ? PN_INF : saturated(sum);
+            res.pn = or_node ? min_value : total;
+            res.dn = or_node ? total : min_value;
+            if (res.pn >= thpn || res.dn >= thdn || res.pn == 0 || res.dn == 0 || stop_all)
+                break;
+
+            // пороги ребенка: его число не должно превысить второе (с запасом epsilon), а сумма - порог узла
+            const uint32_t select_th = or_node ? thpn : thdn;
+            const uint32_t sum_th = or_node ? thdn : thpn;
+            const uint32_t child_select = max(min(select_th, widen(second)), saturated(uint64_t(best_value) + 1));
+            const uint32_t child_other = or_node ? best_entry.dn : best_entry.pn;
+            const uint32_t child_sum = total >= PN_INF - 1 ? sum_th
+                                                          : saturated(uint64_t(sum_th) - total + child_other);
+            mid(state, kids[best].pos, !color, remaining - 1, kids[best].quiet, kids[best].key,
+                or_node ? child_select : child_sum, or_node ? child_sum : child_select);
+        }
+        const uint64_t work = state.local_nodes - nodes_before + 1;
+        table.store(key, res.pn, res.dn, uint32_t(min<uint64_t>(work, UINT32_MAX)), -1);
+        return res;
+    }
+
+    // Ход корня, выигрыш после которого доказан
+    vector<move_pos> winning_move(const position &root, const bool color) const
+    {
+        vector<position> positions;
+        vector<vector<move_pos>> moves;
+        gen::full_moves(root, color, positions, &moves);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            pn_entry e;
+            const uint64_t key = node_key(board_hash(positions[i]), !color, color, settings.max_plies - 1,
+                                          next_quiet(root, positions[i], root_quiet()));
+            if (table.lookup(key, e) && e.pn == 0)
+                return moves[i];
+        }
+        return {};
+    }
+
+    void fill_header(checkpoint_header &h, const uint64_t root_hash, const uint64_t count) const
+    {
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, "CKPN", 4);
+        h.version = CHECKPOINT_VERSION;
+        h.entry_size = sizeof(pn_entry);
+        h.size = N;
+        strncpy(h.rules, Rules::NAME, sizeof(h.rules) - 1);
+        h.root = root_hash;
+        h.max_plies = settings.max_plies;
+        h.quiet_plies = uint16_t(root_quiet());
+        h.quiet_limit = uint16_t(quiet_limit);
+        h.count = count;
+    }
+
+    // Таблица пишется во временный файл и заменяет контрольную точку целиком: прерванная запись не портит старую.
+    // Вызывается и при работающих потоках, поэтому не бросает исключений: неудача запоминается в checkpoint_error
+    bool save_checkpoint(const uint64_t root_hash)
+    {
+        const string tmp = settings.checkpoint_path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+        {
+            ++checkpoint_failures;
+            checkpoint_error = "can't create " + tmp;
+            return false;
+        }
+        checkpoint_header h;
+        fill_header(h, root_hash, 0);
+        fwrite(&h, sizeof(h), 1, f);
+        uint64_t count = 0;
+        bool ok = true;
+        table.for_each_stripe([&](const vector<pn_entry> &chunk) {
+            ok &= fwrite(chunk.data(), sizeof(pn_entry), chunk.size(), f) == chunk.size();
+            count += chunk.size();
+        });
+        fill_header(h, root_hash, count);
+        ok &= fseek(f, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, f) == 1;
+        ok &= fclose(f) == 0;
+        if (!ok || rename(tmp.c_str(), settings.checkpoint_path.c_str()) != 0)
+        {
+            remove(tmp.c_str());
+            ++checkpoint_failures;
+            checkpoint_error = "can't write " + settings.checkpoint_path;
+            return false;
+        }
+        return true;
+    }
+
+    // Записи контрольной точки той же позиции и правил; другая позиция - решение с нуля
+    size_t load_checkpoint(const uint64_t root_hash)
+    {
+        FILE *f = fopen(settings.checkpoint_path.c_str(), "rb");
+        if (!f)
+            return 0;
+        checkpoint_header h, expected;
+        fill_header(expected, root_hash, 0);
+        size_t loaded = 0;
+        if (fread(&h, sizeof(h), 1, f) == 1)
+        {
+            expected.count = h.count;
+            if (memcmp(&h, &expected, sizeof(h)) == 0)
+            {
+                vector<pn_entry> chunk(1 << 16);
+                size_t n;
+                while ((n = fread(chunk.data(), sizeof(pn_entry), chunk.size(), f)) > 0)
+                {
+                    for (size_t i = 0; i < n; ++i)
+                        table.store(chunk[i].key, chunk[i].pn, chunk[i].dn, chunk[i].work);
+                    loaded += n;
+                }
+            }
+        }
+        fclose(f);
+        return loaded;
+    }
+
+    pn_settings settings;
+    int quiet_limit;
+    pn_table table;
+    chrono::steady_clock::time_point start, last_checkpoint;
+    int checkpoint_failures = 0;
+    string checkpoint_error;
+    atomic<uint64_t> nodes{0};
+    atomic<uint64_t> pending_nodes{0}; // узлы работающих потоков, пачками по 1024
+    atomic<bool> stop_all{false};
+    mutex stop_mutex;
+    condition_variable stop_cv;
+    const atomic<bool> *user_stop = nullptr;
+};
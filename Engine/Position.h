@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Начальная расстановка на доске size x size (8 или 10): 1 - белая, 2 - черная, 3 - белая дамка, 4 - черная дамка.
+// У каждой стороны size / 2 - 1 строк шашек.
+inline vector<vector<POS_T>> start_mtx(const int size = 8)
+{
+    vector<vector<POS_T>> mtx(size, vector<POS_T>(size, 0));
+    const int rows = size / 2 - 1;
+    for (POS_T i = 0; i < size; ++i)
+    {
+        for (POS_T j = 0; j < size; ++j)
+        {
+            if (i < rows && (i + j) % 2 == 1)
+                mtx[i][j] = 2;
+            if (i >= size - rows && (i + j) % 2 == 1)
+                mtx[i][j] = 1;
+        }
+    }
+    return mtx;
+}
+
+// Имя клетки в шахматной нотации: столбец y -> буква, строка x -> номер горизонтали (строка 0 - последняя)
+inline string cell_name(const POS_T x, const POS_T y, const int size = 8)
+{
+    return string(1, char('a' + y)) + to_string(size - x);
+}
+
+// Клетка по имени из cell_name; false - имя не из доски size x size
+inline bool cell_from_name(const string &name, const int size, POS_T &x, POS_T &y)
+{
+    if (name.size() < 2 || name[0] < 'a' || name[0] >= 'a' + size ||
+        name.find_first_not_of("0123456789", 1) != string::npos || name.size() > 3)
+        return false;
+    const int row = stoi(name.substr(1));
+    if (row < 1 || row > size)
+        return false;
+    x = POS_T(size - row);
+    y = POS_T(name[0] - 'a');
+    return true;
+}
+
+// Запись хода с серией взятий, например "c3-d4" или "c3:e5:c7"
+inline string turns_to_string(const vector<move_pos> &turns, const int size = 8)
+{
+    if (turns.empty())
+        return "";
+    string res = cell_name(turns[0].x, turns[0].y, size);
+    for (const auto &turn : turns)
+    {
+        res += (turn.xb != -1 ? ":" : "-");
+        res += cell_name(turn.x2, turn.y2, size);
+    }
+    return res;
+}
+
+// Доска из строки вида ".b.b.b.b/b.b.b.b./..." (строки через '/', их число задает размер доски - 8 или 10):
+// '.' - пусто, 'w'/'b' - белая/черная шашка, 'W'/'B' - белая/черная дамка
+inline vector<vector<POS_T>> mtx_from_string(const string &str)
+{
+    const int size = str.find('/') == string::npos ? 8 : int(count(str.begin(), str.end(), '/')) + 1;
+    vector<vector<POS_T>> mtx(size, vector<POS_T>(size, 0));
+    POS_T i = 0, j = 0;
+    for (char c : str)
+    {
+        if (c == '/')
+        {
+            ++i;
+            j = 0;
+            continue;
+        }
+        if (i >= size || j >= size)
+            break;
+        mtx[i][j++] = (c == 'w' ? 1 : c == 'b' ? 2 : c == 'W' ? 3 : c == 'B' ? 4 : 0);
+    }
+    return mtx;
+}
+
+inline string mtx_to_string(const vector<vector<POS_T>> &mtx)
+{
+    string res;
+    for (size_t i = 0; i < mtx.size(); ++i)
+    {
+        if (i)
+            res += '/';
+        for (size_t j = 0; j < mtx.size(); ++j)
+            res += ".wbWB"[mtx[i][j]];
+    }
+    return res;
+}
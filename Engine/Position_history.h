@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Позиции партии с последнего необратимого хода (взятие или ход шашкой) и правила ничьей по ним:
+// позиция с той же стороной хода повторилась repetitions раз или quiet_turns ходов подряд (обеих сторон вместе)
+// нет взятий и ходов шашками. Позиции до необратимого хода повториться уже не могут и не хранятся.
+// Нулевой порог выключает правило
+class position_history
+{
+  public:
+    position_history(const int repetitions = 3, const int quiet_turns = 0)
+        : repetitions(repetitions), quiet_turns(quiet_turns)
+    {
+    }
+
+    void clear()
+    {
+        boards.clear();
+        keys.clear();
+    }
+
+    // Позиция mtx перед ходом стороны color
+    void push(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        if (!boards.empty() && !reversible(boards.back(), mtx))
+            clear();
+        boards.push_back(mtx);
+        keys.push_back(position_key(mtx, color));
+    }
+
+    // История заново по доскам перед каждым ходом партии (первый ход - белых); откат хода укорачивает record,
+    // поэтому проще пройти его хвост заново, чем отменять позиции
+    void assign(const vector<vector<vector<POS_T>>> &record)
+    {
+        clear();
+        size_t first = record.empty() ? 0 : record.size() - 1;
+        while (first > 0 && reversible(record[first - 1], record[first]))
+            --first;
+        for (size_t t = first; t < record.size(); ++t)
+            push(record[t], t % 2);
+    }
+
+    // Ничья по правилам в последней позиции: "repetition", "quiet_moves" или пустая строка
+    string draw() const
+    {
+        if (keys.empty())
+            return "";
+        if (repetitions > 0 && count(keys.begin(), keys.end(), keys.back()) >= repetitions)
+            return "repetition";
+        if (quiet_turns > 0 && int(boards.size()) - 1 >= quiet_turns)
+            return "quiet_moves";
+        return "";
+    }
+
+    // Обратимых ходов подряд до последней позиции
+    int quiet_plies() const
+    {
+        return boards.empty() ? 0 : int(boards.size()) - 1;
+    }
+
+    // Позиции перед последней по порядку (для Logic::history)
+    vector<vector<vector<POS_T>>> previous() const
+    {
+        if (boards.empty())
+            return {};
+        return vector<vector<vector<POS_T>>>(boards.begin(), boards.end() - 1);
+    }
+
+    // Ход из before в after обратим: никто не бил и шашки стоят на тех же клетках (превращение в дамку - ход шашкой)
+    static bool reversible(const vector<vector<POS_T>> &before, const vector<vector<POS_T>> &after)
+    {
+        int pieces = 0;
+        for (size_t i = 0; i < before.size(); ++i)
+            for (size_t j = 0; j < before[i].size(); ++j)
+            {
+                const POS_T b = before[i][j], a = after[i][j];
+                if ((b == 1 || b == 2 || a == 1 || a == 2) && b != a)
+                    return false;
+                pieces += (b != 0) - (a != 0);
+            }
+        return pieces == 0;
+    }
+
+  private:
+    // Хеш расстановки и стороны хода (FNV-1a)
+    static uint64_t position_key(const vector<vector<POS_T>> &mtx, const bool color)
+    {
+        uint64_t hash = 0xCBF29CE484222325ull ^ color;
+        for (const auto &row : mtx)
+            for (const POS_T c : row)
+            {
+                hash ^= uint8_t(c);
+                hash *= 0x100000001B3ull;
+            }
+        return hash;
+    }
+
+    int repetitions;
+    int quiet_turns;
+    vector<vector<vector<POS_T>>> boards;
+    vector<uint64_t> keys;
+};
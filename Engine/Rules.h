@@ -0,0 +1,69 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Правила варианта шашек - политика генератора ходов (movegen<N, Rules>) и логики (BoardLogic<N, Rules>).
+// Все поля constexpr, ветки по ним убираются при компиляции: у каждого варианта свой генератор без проверок в узлах.
+// Правило превращения шашки в дамку, если она дошла до последней строки взятием
+enum class promotion_rule
+{
+    continue_capture, // становится дамкой сразу и продолжает взятие как дамка
+    end_move,         // становится дамкой, ход на этом заканчивается
+    end_of_capture    // становится дамкой, только если взятие на этой клетке заканчивается, иначе бьет дальше как шашка
+};
+
+// Русские шашки: шашки бьют назад, дамки дальнобойные, превращение во время взятия, можно бить любое количество
+struct russian_rules
+{
+    static constexpr const char *NAME = "Russian";
+    static constexpr bool MEN_CAPTURE_BACKWARD = true;
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool MAJORITY_CAPTURE = false;
+    static constexpr promotion_rule PROMOTION = promotion_rule::continue_capture;
+    static constexpr int QUIET_DRAW_MOVES = 15; // ничья: 15 ходов каждой стороны только дамками и без взятий
+};
+
+// Английские (американские) шашки: шашки бьют только вперед, дамки ходят и бьют на одну клетку,
+// шашка, ставшая дамкой, заканчивает ход
+struct english_rules
+{
+    static constexpr const char *NAME = "English";
+    static constexpr bool MEN_CAPTURE_BACKWARD = false;
+    static constexpr bool FLYING_KINGS = false;
+    static constexpr bool MAJORITY_CAPTURE = false;
+    static constexpr promotion_rule PROMOTION = promotion_rule::end_move;
+    static constexpr int QUIET_DRAW_MOVES = 40; // правило 40 ходов
+};
+
+// Бразильские шашки (международные правила на доске 8 x 8): бить нужно наибольшее количество фигур,
+// шашка, прошедшая последнюю строку во время взятия, остается шашкой
+struct brazilian_rules
+{
+    static constexpr const char *NAME = "Brazilian";
+    static constexpr bool MEN_CAPTURE_BACKWARD = true;
+    static constexpr bool FLYING_KINGS = true;
+    static constexpr bool MAJORITY_CAPTURE = true;
+    static constexpr promotion_rule PROMOTION = promotion_rule::end_of_capture;
+    static constexpr int QUIET_DRAW_MOVES = 20; // 20 ходов дамками без взятий
+};
+
+// Вызывает f(правила) для варианта с именем name ("Russian", "English" или "Brazilian"); выбор делается один раз,
+// дальше код работает с конкретным типом правил
+template <class F> auto visit_rules(const string &name, F &&f)
+{
+    if (name == english_rules::NAME)
+        return f(english_rules());
+    if (name == brazilian_rules::NAME)
+        return f(brazilian_rules());
+    if (name == russian_rules::NAME)
+        return f(russian_rules());
+    throw runtime_error("unknown rules " + name + " (expected Russian, English or Brazilian)");
+}
+
+// Ничья по правилам name: столько ходов подряд (обеих сторон вместе) без взятий и ходов шашками
+inline int quiet_draw_turns(const string &name)
+{
+    return visit_rules(name, [](auto rules) { return 2 * decltype(rules)::QUIET_DRAW_MOVES; });
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Batch_eval.h"
+#include "Rules.h"
+
+using namespace std;
+
+// Двоичный формат данных самоигры (checkers_selfplay) для обучения оценки.
+// Файл (шард): заголовок header, затем записи record фиксированного размера подряд до конца файла, числа little-endian.
+// Позиция хранится масками 8 x 8 как packed_position (см. Batch_eval.h): записи читаются блоками без разбора текста
+// и сразу годятся для evaluate_batch.
+namespace selfplay
+{
+const uint32_t FILE_VERSION = 1;
+// Результат партии с точки зрения белых
+const uint8_t BLACK_WINS = 0, DRAW = 1, WHITE_WINS = 2;
+
+struct header
+{
+    char magic[4];        // "CKSP"
+    uint32_t version;     // FILE_VERSION
+    uint32_t record_size; // sizeof(record)
+    uint32_t rules;       // rules_code
+};
+
+// 24 байта на позицию
+struct record
+{
+    uint32_t men[2];  // шашки белых и черных
+    uint32_t kings[2];
+    int32_t score;    // оценка поиска с точки зрения ходящего (шкала Logic, см. SCORE_SCALE и WIN_SCORE)
+    uint8_t from;     // лучший ход: клетка начала и клетка конца (номер клетки, см. Geometry.h)
+    uint8_t to;
+    uint8_t color;    // кто ходит: 0 - белые, 1 - черные
+    uint8_t result;   // BLACK_WINS, DRAW или WHITE_WINS
+
+    void set_position(const packed_position &pos)
+    {
+        for (int c = 0; c < 2; ++c)
+        {
+            men[c] = pos.men[c];
+            kings[c] = pos.kings[c];
+        }
+    }
+
+    packed_position position() const
+    {
+        packed_position pos;
+        for (int c = 0; c < 2; ++c)
+        {
+            pos.men[c] = men[c];
+            pos.kings[c] = kings[c];
+        }
+        return pos;
+    }
+};
+
+static_assert(sizeof(header) == 16, "selfplay header must stay 16 bytes");
+static_assert(sizeof(record) == 24, "selfplay record must stay 24 bytes");
+
+inline uint32_t rules_code(const string &rules)
+{
+    return rules == english_rules::NAME ? 1 : rules == brazilian_rules::NAME ? 2 : 0;
+}
+
+inline const char *rules_name(const uint32_t code)
+{
+    return code == 1 ? english_rules::NAME : code == 2 ? brazilian_rules::NAME : russian_rules::NAME;
+}
+
+// Запись шардами: prefix-00000.ckd, prefix-00001.ckd, ...; новый файл начинается, когда в текущем
+// shard_records записей. Потоки копят записи у себя и отдают их пачками, файл пишется блоками без своего буфера.
+class shard_writer
+{
+  public:
+    shard_writer(const string &prefix, const size_t shard_records, const string &rules)
+        : prefix(prefix), shard_records(max<size_t>(shard_records, 1)), rules(rules_code(rules))
+    {
+    }
+
+    shard_writer(const shard_writer &) = delete;
+    shard_writer &operator=(const shard_writer &) = delete;
+
+    ~shard_writer()
+    {
+        if (file)
+            fclose(file);
+    }
+
+    // Дописывает пачку записей, при необходимости переходя к следующему шарду
+    void write(const vector<record> &records)
+    {
+        lock_guard<mutex> lock(write_mutex);
+        size_t done = 0;
+        while (done < records.size())
+        {
+            if (!file || in_shard == shard_records)
+                open_next();
+            const size_t n = min(records.size() - done, shard_records - in_shard);
+            if (fwrite(records.data() + done, sizeof(record), n, file) != n)
+                throw runtime_error("can't write " + shard_path(shard - 1));
+            done += n;
+            in_shard += n;
+            total += n;
+        }
+    }
+
+    size_t records() const
+    {
+        return total;
+    }
+
+    size_t shards() const
+    {
+        return shard;
+    }
+
+    string shard_path(const size_t index) const
+    {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "-%05zu.ckd", index);
+        return prefix + suffix;
+    }
+
+  private:
+    void open_next()
+    {
+        if (file)
+            fclose(file);
+        const string path = shard_path(shard++);
+        file = fopen(path.c_str(), "wb");
+        if (!file)
+            throw runtime_error("can't create " + path);
+        header h;
+        memcpy(h.magic, "CKSP", 4);
+        h.version = FILE_VERSION;
+        h.record_size = sizeof(record);
+        h.rules = rules;
+        fwrite(&h, sizeof(h), 1, file);
+        in_shard = 0;
+    }
+
+    string prefix;
+    size_t shard_records;
+    uint32_t rules;
+    mutex write_mutex;
+    FILE *file = nullptr;
+    size_t shard = 0;
+    size_t in_shard = 0;
+    size_t total = 0;
+};
+
+// Файл самоигры ли это (по заголовку)
+inline bool is_selfplay_file(const string &path)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    char magic[4] = {};
+    const bool res = fread(magic, 1, 4, f) == 4 && memcmp(magic, "CKSP", 4) == 0;
+    fclose(f);
+    return res;
+}
+
+// Все записи шарда; false - файл не открылся или это не шард нужной версии
+inline bool load(const string &path, vector<record> &records, header *info = nullptr)
+{
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+    header h;
+    bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, "CKSP", 4) == 0 && h.version == FILE_VERSION &&
+              h.record_size == sizeof(record);
+    if (ok)
+    {
+        const size_t BATCH = 1 << 16;
+        size_t n;
+        do
+        {
+            const size_t old = records.size();
+            records.resize(old + BATCH);
+            n = fread(records.data() + old, sizeof(record), BATCH, f);
+            records.resize(old + n);
+        } while (n == BATCH);
+        if (info)
+            *info = h;
+    }
+    fclose(f);
+    return ok;
+}
+} // namespace selfplay
@@ -0,0 +1,483 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../Models/Move.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+// Ключи Zobrist: фигура каждого типа на каждой темной клетке, сторона хода и клетка фигуры, продолжающей взятие.
+// Клеток хватает на доску 10 x 10, доска 8 x 8 использует первые 32.
+const int ZOBRIST_SQUARES = 50;
+
+struct zobrist_keys
+{
+    uint64_t piece[ZOBRIST_SQUARES][5];
+    uint64_t side;
+    uint64_t forced[ZOBRIST_SQUARES];
+
+    zobrist_keys()
+    {
+        mt19937_64 rng(0x9E3779B97F4A7C15ull);
+        for (auto &cell : piece)
+            for (auto &key : cell)
+                key = rng();
+        side = rng();
+        for (auto &key : forced)
+            key = rng();
+    }
+};
+
+inline const zobrist_keys &zobrist()
+{
+    static const zobrist_keys keys;
+    return keys;
+}
+
+// Хеш расстановки фигур (без стороны хода)
+template <int N> uint64_t board_hash(const bit_position<N> &pos)
+{
+    uint64_t hash = 0;
+    for (int type = 1; type <= 4; ++type)
+    {
+        const auto &masks = type > 2 ? pos.kings : pos.men;
+        for (auto rest = masks[type % 2 == 0]; rest; rest &= rest - 1)
+            hash ^= zobrist().piece[lowest_bit(rest)][type];
+    }
+    return hash;
+}
+
+// Изменение хеша расстановки между позициями до и после шага: за шаг меняются две-три клетки,
+// поэтому хеш обновляется по разнице масок, и превращение в дамку по любым правилам учитывается само
+template <int N> uint64_t board_hash_delta(const bit_position<N> &before, const bit_position<N> &after)
+{
+    uint64_t delta = 0;
+    for (int type = 1; type <= 4; ++type)
+    {
+        const bool color = type % 2 == 0;
+        const auto changed = type > 2 ? before.kings[color] ^ after.kings[color] : before.men[color] ^ after.men[color];
+        for (auto rest = changed; rest; rest &= rest - 1)
+            delta ^= zobrist().piece[lowest_bit(rest)][type];
+    }
+    return delta;
+}
+
+// Тип оценки в записи: точная, нижняя граница (было отсечение) или верхняя (ни один ход не поднял alpha)
+const int8_t TT_EXACT = 0;
+const int8_t TT_LOWER = 1;
+const int8_t TT_UPPER = 2;
+
+// Запись таблицы: лучший шаг, найденный в узле, и его оценка с типом границы (в памяти хранится упакованной в tt_slot)
+struct tt_entry
+{
+    uint64_t key = 0;
+    move_pos move{-1, -1, -1, -1};
+    int32_t score = 0;
+    int8_t depth = -1; // оставшаяся глубина, на которой найден ход
+    int8_t bound = TT_EXACT;
+};
+
+// Файл таблицы (кэш поиска между запусками): заголовок tt_file_header, затем непустые записи tt_file_record.
+// fingerprint - отпечаток правил и оценки: оценки из таблицы с другим отпечатком не годятся, файл не загружается.
+// checksum - FNV-1a всех записей: файл с испорченными записями не загружается целиком
+struct tt_file_header
+{
+    char magic[4];        // "CKTT"
+    uint32_t version;     // TT_FILE_VERSION
+    uint32_t record_size; // sizeof(tt_file_record)
+    uint32_t count;
+    uint64_t fingerprint;
+    uint64_t checksum;
+};
+
+// 20 байт на запись вместо 24 в памяти
+struct tt_file_record
+{
+    uint32_t key[2]; // младшие и старшие 32 бита ключа
+    int32_t score;
+    POS_T move[6];   // x, y, x2, y2, xb, yb
+    int8_t depth;
+    int8_t bound;
+};
+
+const uint32_t TT_FILE_VERSION = 2;
+static_assert(sizeof(tt_file_header) == 32, "tt file header must stay 32 bytes");
+static_assert(sizeof(tt_file_record) == 20, "tt file record must stay 20 bytes");
+
+// Ячейка таблицы в памяти - 16 байт: data - упакованные ход, оценка, глубина и граница (см. pack), check = key ^ data.
+// Ячейки читаются и пишутся без блокировок: если другой поток или процесс переписал ячейку между чтениями двух слов,
+// check ^ data не совпадет с ключом, и запись просто не найдется
+struct tt_slot
+{
+    atomic<uint64_t> check;
+    atomic<uint64_t> data;
+};
+
+static_assert(sizeof(tt_slot) == 16, "tt slot must stay 16 bytes");
+
+// Заголовок общей таблицы в именованной памяти (shm); ячейки начинаются с TT_SHARED_OFFSET.
+// Создатель сегмента заполняет заголовок и последним пишет ready = TT_SHARED_MAGIC
+struct tt_shared_header
+{
+    atomic<uint32_t> ready;
+    uint32_t version;     // TT_FILE_VERSION
+    uint64_t count;       // число ячеек, степень двойки
+    uint64_t fingerprint; // отпечаток правил и оценки создателя
+};
+
+const uint32_t TT_SHARED_MAGIC = 0x53544B43; // "CKTS"
+const size_t TT_SHARED_OFFSET = 64;
+
+// Таблица транспозиций с прямой адресацией: размер - степень двойки, при коллизии запись заменяется.
+// Ячейки - своя память процесса (resize) или именованный сегмент общей памяти (attach_shared), к которому
+// подключаются другие процессы и потоки с теми же правилами и оценкой: поиск каждого видит записи остальных
+class transposition_table
+{
+  public:
+    transposition_table() = default;
+    transposition_table(const transposition_table &) = delete;
+    transposition_table &operator=(const transposition_table &) = delete;
+
+    ~transposition_table()
+    {
+        detach();
+    }
+
+    void resize(const size_t size_mb)
+    {
+        detach();
+        const size_t count = slots_for(size_mb);
+        local.reset(new tt_slot[count]);
+        slots = local.get();
+        mask = count - 1;
+        clear();
+    }
+
+    // Подключает таблицу к сегменту общей памяти name (на Linux - /dev/shm/name), создавая его на size_mb,
+    // если его еще нет; размер существующего сегмента задал его создатель. Сегмент живет, пока его не удалят
+    // (shm_unlink, rm /dev/shm/name), поэтому следующие запуски тоже начинают с его записей.
+    // false - сегмент не подключился, причина - в error
+    bool attach_shared(const string &name, const size_t size_mb, const uint64_t fingerprint, string &error)
+    {
+        detach();
+        error.clear();
+#ifndef _WIN32
+        const string shm_name = name[0] == '/' ? name : "/" + name;
+        const string path = "/dev/shm" + shm_name;
+        int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        const bool creator = fd >= 0;
+        if (!creator && errno == EEXIST)
+            fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            error = "can't open shared memory " + path + ": " + strerror(errno);
+            return false;
+        }
+
+        size_t count = slots_for(size_mb);
+        size_t size = TT_SHARED_OFFSET + count * sizeof(tt_slot);
+        if (creator && ftruncate(fd, off_t(size)) != 0)
+        {
+            error = "can't size shared memory " + path + ": " + strerror(errno);
+            ::close(fd);
+            shm_unlink(shm_name.c_str());
+            return false;
+        }
+        if (!creator)
+        {
+            // создатель мог еще не задать размер
+            struct stat st;
+            for (int wait = 0; (fstat(fd, &st) != 0 || size_t(st.st_size) < TT_SHARED_OFFSET) && wait < 2000; ++wait)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            size = size_t(st.st_size);
+        }
+        if (size < TT_SHARED_OFFSET)
+        {
+            error = "shared transposition table " + path + " is empty: its creator stopped before sizing it, "
+                    "remove the file";
+            ::close(fd);
+            return false;
+        }
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+        {
+            error = "can't map shared memory " + path + ": " + strerror(errno);
+            return false;
+        }
+        shared_size = size;
+
+        if (creator)
+        {
+            // объекты заголовка и ячеек создаются на месте; новые байты сегмента - нули, то есть пустые ячейки,
+            // поэтому ячейки создаются без инициализации
+            shared = new (ptr) tt_shared_header();
+            tt_slot *first = (tt_slot *)((char *)ptr + TT_SHARED_OFFSET);
+            for (size_t i = 0; i < count; ++i)
+                new (first + i) tt_slot;
+            shared->version = TT_FILE_VERSION;
+            shared->count = count;
+            shared->fingerprint = fingerprint;
+            shared->ready.store(TT_SHARED_MAGIC, memory_order_release);
+        }
+        else
+        {
+            shared = (tt_shared_header *)ptr;
+            for (int wait = 0; shared->ready.load(memory_order_acquire) != TT_SHARED_MAGIC && wait < 2000; ++wait)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            count = size_t(shared->count);
+            if (shared->ready.load(memory_order_acquire) != TT_SHARED_MAGIC)
+                error = "shared transposition table " + path + " was never initialized: its creator stopped "
+                        "before finishing it, remove the file";
+            else if (shared->version != TT_FILE_VERSION || count == 0 || (count & (count - 1)) ||
+                     TT_SHARED_OFFSET + count * sizeof(tt_slot) > size)
+                error = "shared transposition table " + path + " has another format, remove the file";
+            else if (shared->fingerprint != fingerprint)
+                error = "shared transposition table " + path +
+                        " was made for other rules, board size or evaluation";
+            if (!error.empty())
+            {
+                detach();
+                return false;
+            }
+        }
+        slots = (tt_slot *)((char *)ptr + TT_SHARED_OFFSET);
+        mask = count - 1;
+        return true;
+#else
+        (void)name;
+        (void)size_mb;
+        (void)fingerprint;
+        error = "shared transposition tables are not supported on Windows";
+        return false;
+#endif
+    }
+
+    // Таблица в общей памяти: ее записи принадлежат всем подключенным процессам
+    bool is_shared() const
+    {
+        return shared != nullptr;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; slots && i <= mask; ++i)
+        {
+            slots[i].check.store(0, memory_order_relaxed);
+            slots[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+    // Запись позиции key; false - ее нет (или ячейку в этот момент переписывают)
+    bool probe(const uint64_t key, tt_entry &entry) const
+    {
+        if (!slots)
+            return false;
+        const tt_slot &slot = slots[key & mask];
+        const uint64_t data = slot.data.load(memory_order_relaxed);
+        if ((slot.check.load(memory_order_relaxed) ^ data) != key || !(data >> 24 & 0xFF))
+            return false;
+        entry = unpack(key, data);
+        return true;
+    }
+
+    void store(const uint64_t key, const move_pos &move, const int depth, const int score, const int8_t bound)
+    {
+        if (!slots)
+            return;
+        tt_slot &slot = slots[key & mask];
+        // ход с меньшей глубины той же позиции не вытесняет более глубокий
+        const uint64_t old = slot.data.load(memory_order_relaxed);
+        if ((slot.check.load(memory_order_relaxed) ^ old) == key && int(old >> 24 & 0xFF) - 1 > depth)
+            return;
+        const uint64_t data = pack(move, depth, score, bound);
+        slot.data.store(data, memory_order_relaxed);
+        slot.check.store(key ^ data, memory_order_relaxed);
+    }
+
+    // Сохраняет непустые записи в path (через временный файл, прежний файл не портится); false - не записалось
+    bool save(const string &path, const uint64_t fingerprint) const
+    {
+        const string tmp = path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+            return false;
+        tt_file_header h;
+        memcpy(h.magic, "CKTT", 4);
+        h.version = TT_FILE_VERSION;
+        h.record_size = sizeof(tt_file_record);
+        h.count = 0;
+        h.fingerprint = fingerprint;
+        h.checksum = FNV_OFFSET;
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+        vector<tt_file_record> block;
+        block.reserve(4096);
+        auto flush = [&]() {
+            ok &= fwrite(block.data(), sizeof(tt_file_record), block.size(), f) == block.size();
+            h.checksum = fnv1a(h.checksum, block.data(), block.size() * sizeof(tt_file_record));
+            h.count += uint32_t(block.size());
+            block.clear();
+        };
+        for (size_t i = 0; slots && i <= mask; ++i)
+        {
+            const uint64_t data = slots[i].data.load(memory_order_relaxed);
+            if (!(data >> 24 & 0xFF))
+                continue;
+            const tt_entry entry = unpack(slots[i].check.load(memory_order_relaxed) ^ data, data);
+            tt_file_record rec;
+            rec.key[0] = uint32_t(entry.key);
+            rec.key[1] = uint32_t(entry.key >> 32);
+            rec.score = entry.score;
+            const POS_T move[6] = {entry.move.x, entry.move.y, entry.move.x2, entry.move.y2, entry.move.xb, entry.move.yb};
+            memcpy(rec.move, move, sizeof(move));
+            rec.depth = entry.depth;
+            rec.bound = entry.bound;
+            block.push_back(rec);
+            if (block.size() == block.capacity())
+                flush();
+        }
+        flush();
+        ok &= fseek(f, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, f) == 1;
+        ok &= fclose(f) == 0;
+        // rename заменяет прежний файл атомарно (на Windows - только если его нет)
+        if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Добавляет записи из файла для доски size x size (как store: более глубокая запись позиции не вытесняется).
+    // Записи проверяются до загрузки: файл обрезан или не сходится checksum - не загружается ничего; запись с ходом
+    // не по темным клеткам доски или с невозможной глубиной, границей или оценкой пропускается.
+    // Число загруженных записей; 0 - файла нет, он поврежден или от другой оценки
+    size_t load(const string &path, const uint64_t fingerprint, const int size)
+    {
+        if (!slots)
+            return 0;
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f)
+            return 0;
+        tt_file_header h;
+        vector<tt_file_record> records;
+        bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, "CKTT", 4) == 0 &&
+                  h.version == TT_FILE_VERSION && h.record_size == sizeof(tt_file_record) && h.fingerprint == fingerprint;
+        uint64_t checksum = FNV_OFFSET;
+        while (ok && records.size() < h.count)
+        {
+            const size_t first = records.size();
+            records.resize(first + min<size_t>(4096, h.count - first));
+            const size_t n = records.size() - first;
+            ok = fread(records.data() + first, sizeof(tt_file_record), n, f) == n;
+            checksum = fnv1a(checksum, records.data() + first, n * sizeof(tt_file_record));
+        }
+        fclose(f);
+        if (!ok || checksum != h.checksum)
+            return 0;
+
+        size_t loaded = 0;
+        for (const tt_file_record &rec : records)
+        {
+            const move_pos move(rec.move[0], rec.move[1], rec.move[2], rec.move[3], rec.move[4], rec.move[5]);
+            if (!valid_record(rec, move, size))
+                continue;
+            store(uint64_t(rec.key[1]) << 32 | rec.key[0], move, rec.depth, rec.score, rec.bound);
+            ++loaded;
+        }
+        return loaded;
+    }
+
+  private:
+    static constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+
+    static uint64_t fnv1a(uint64_t hash, const void *data, const size_t bytes)
+    {
+        const auto *p = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            hash ^= p[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    // Запись из файла годится для доски size x size: клетки хода темные и на доске, бьется фигура на темной клетке
+    // или никто, глубина, граница и оценка помещаются в упакованную ячейку
+    static bool valid_record(const tt_file_record &rec, const move_pos &move, const int size)
+    {
+        auto dark = [size](const int i, const int j) { return i >= 0 && i < size && j >= 0 && j < size && (i + j) % 2; };
+        const bool beat_ok = (move.xb == -1 && move.yb == -1) || dark(move.xb, move.yb);
+        return dark(move.x, move.y) && dark(move.x2, move.y2) && beat_ok && rec.depth >= 0 && rec.bound >= TT_EXACT &&
+               rec.bound <= TT_UPPER && rec.score >= -(1 << 29) && rec.score < (1 << 29);
+    }
+
+    // Наибольшая степень двойки ячеек, которая помещается в size_mb (не меньше одной)
+    static size_t slots_for(const size_t size_mb)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(tt_slot) <= size_mb * 1024 * 1024)
+            count *= 2;
+        return count;
+    }
+
+    // Биты data: 0-23 - ход по 4 бита на координату (xb и yb со сдвигом на 1, -1 - нет взятия),
+    // 24-31 - глубина + 1 (0 - пустая ячейка), 32-33 - граница, 34-63 - оценка (30 бит со знаком)
+    static uint64_t pack(const move_pos &move, const int depth, const int score, const int8_t bound)
+    {
+        return uint64_t(move.x & 15) | uint64_t(move.y & 15) << 4 | uint64_t(move.x2 & 15) << 8 |
+               uint64_t(move.y2 & 15) << 12 | uint64_t((move.xb + 1) & 15) << 16 | uint64_t((move.yb + 1) & 15) << 20 |
+               uint64_t(uint8_t(depth + 1)) << 24 | uint64_t(bound & 3) << 32 | uint64_t(uint32_t(score) & 0x3FFFFFFF) << 34;
+    }
+
+    static tt_entry unpack(const uint64_t key, const uint64_t data)
+    {
+        tt_entry entry;
+        entry.key = key;
+        entry.move = move_pos(POS_T(data & 15), POS_T(data >> 4 & 15), POS_T(data >> 8 & 15), POS_T(data >> 12 & 15),
+                              POS_T(int(data >> 16 & 15) - 1), POS_T(int(data >> 20 & 15) - 1));
+        entry.depth = int8_t(int(data >> 24 & 0xFF) - 1);
+        entry.bound = int8_t(data >> 32 & 3);
+        entry.score = int32_t(uint32_t(data >> 34) << 2) >> 2;
+        return entry;
+    }
+
+    void detach()
+    {
+#ifndef _WIN32
+        if (shared)
+            munmap((void *)shared, shared_size);
+#endif
+        shared = nullptr;
+        shared_size = 0;
+        local.reset();
+        slots = nullptr;
+        mask = 0;
+    }
+
+    tt_slot *slots = nullptr;
+    size_t mask = 0;
+    // своя память или отображенный сегмент общей памяти (заголовок, за ним ячейки)
+    unique_ptr<tt_slot[]> local;
+    tt_shared_header *shared = nullptr;
+    size_t shared_size = 0;
+};
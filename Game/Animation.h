@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Анимация ходов. Доска (Board::mtx) меняется сразу, а шаги ходов ставятся в очередь и проигрываются по часам кадров:
+// каждый кадр рисует фигуру между клетками по текущему времени. Логика игры и ввод не ждут отрисовки,
+// серия взятий - несколько шагов подряд в одной очереди.
+struct piece_step
+{
+    POS_T x, y, x2, y2;   // откуда и куда
+    POS_T xb, yb;         // взятая фигура или -1
+    POS_T type;           // фигура до шага (после шага она может стать дамкой)
+    POS_T beaten_type;    // взятая фигура, видна до конца шага
+    uint32_t start_ms;    // начало по часам кадров (SDL_GetTicks)
+    uint32_t duration_ms;
+
+    uint32_t end_ms() const
+    {
+        return start_ms + duration_ms;
+    }
+};
+
+class Timeline
+{
+  public:
+    // Ставит шаг после уже поставленных; gap_ms - пауза перед ним после конца предыдущего шага
+    void push(piece_step step, const uint32_t now_ms, const uint32_t gap_ms)
+    {
+        step.start_ms = steps.empty() ? now_ms : max(now_ms, steps.back().end_ms() + gap_ms);
+        steps.push_back(step);
+    }
+
+    // Убирает законченные шаги; true - есть что анимировать
+    bool update(const uint32_t now_ms)
+    {
+        while (!steps.empty() && steps.front().end_ms() <= now_ms)
+            steps.pop_front();
+        return !steps.empty();
+    }
+
+    bool active() const
+    {
+        return !steps.empty();
+    }
+
+    void clear()
+    {
+        steps.clear();
+    }
+
+    // Клетка, которую фигура из mtx еще не заняла на экране: туда идет незаконченный шаг
+    bool hides(const POS_T i, const POS_T j) const
+    {
+        for (const auto &step : steps)
+            if (step.x2 == i && step.y2 == j)
+                return true;
+        return false;
+    }
+
+    // Для каждой фигуры, которую надо нарисовать поверх доски, вызывает f(тип, строка, столбец) в долях клетки:
+    // взятые фигуры до конца их шага, движущуюся фигуру между клетками и фигуры, чей шаг еще не начался
+    template <class F> void for_each_piece(const uint32_t now_ms, F &&f) const
+    {
+        for (size_t k = 0; k < steps.size(); ++k)
+        {
+            const piece_step &step = steps[k];
+            if (step.xb != -1)
+                f(step.beaten_type, double(step.xb), double(step.yb));
+            if (now_ms >= step.start_ms)
+            {
+                const double t = min(1.0, double(now_ms - step.start_ms) / max<uint32_t>(step.duration_ms, 1));
+                // сглаживание в начале и в конце шага
+                const double s = t * t * (3 - 2 * t);
+                f(step.type, step.x + (step.x2 - step.x) * s, step.y + (step.y2 - step.y) * s);
+                continue;
+            }
+            // шаг ждет своей очереди: фигура стоит на начальной клетке, если ее туда не везет предыдущий шаг
+            bool arriving = false;
+            for (size_t p = 0; p < k; ++p)
+                arriving |= steps[p].x2 == step.x && steps[p].y2 == step.y;
+            if (!arriving)
+                f(step.type, double(step.x), double(step.y));
+        }
+    }
+
+  private:
+    deque<piece_step> steps;
+};
@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Engine/Mapped_file.h"
+
+#ifdef __APPLE__
+    #include <SDL.h>
+    #include <SDL_image.h>
+#else
+    #include <SDL.h>
+    #include <SDL_image.h>
+#endif
+
+using namespace std;
+
+// Все картинки игры в одной текстуре. Файл атласа (*.ckat) хранит уже раскодированные пиксели RGBA,
+// поэтому при запуске он отображается в память и загружается одной текстурой без декодирования PNG.
+// Если атласа нет или какой-то PNG новее его, атлас собирается из PNG и сохраняется для следующих запусков
+// в кэш пользователя (см. paths): каталог Textures может быть доступен только для чтения.
+enum atlas_sprite
+{
+    SPRITE_BOARD,
+    SPRITE_PIECE_WHITE,
+    SPRITE_PIECE_BLACK,
+    SPRITE_QUEEN_WHITE,
+    SPRITE_QUEEN_BLACK,
+    SPRITE_BACK,
+    SPRITE_REPLAY,
+    SPRITE_WHITE_WINS,
+    SPRITE_BLACK_WINS,
+    SPRITE_DRAW,
+    SPRITE_COUNT
+};
+
+namespace atlas
+{
+const uint32_t FILE_VERSION = 1;
+// Ширина атласа; картинки раскладываются полками слева направо
+const int WIDTH = 2048;
+
+struct source
+{
+    const char *file;
+    int max_side; // картинка уменьшается так, чтобы большая сторона была не больше max_side
+};
+
+// Исходные картинки в порядке atlas_sprite
+inline const source *sources()
+{
+    static const source list[SPRITE_COUNT] = {
+        {"board.png", 1024},       {"piece_white.png", 256}, {"piece_black.png", 256}, {"queen_white.png", 256},
+        {"queen_black.png", 256},  {"back.png", 256},        {"replay.png", 256},      {"white_wins.png", 1024},
+        {"black_wins.png", 1024},  {"draw.png", 1024},
+    };
+    return list;
+}
+
+// Заголовок файла: "CKAT", версия, ширина, высота, затем SPRITE_COUNT прямоугольников и пиксели RGBA построчно
+struct header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t count;
+    int32_t rects[SPRITE_COUNT][4];
+};
+
+// Атлас в памяти: пиксели либо из отображенного файла, либо из только что собранного буфера
+struct image
+{
+    int width = 0;
+    int height = 0;
+    SDL_Rect rects[SPRITE_COUNT];
+    const uint8_t *pixels = nullptr;
+    MappedFile file;
+    vector<uint8_t> buffer;
+};
+
+inline bool load(const string &path, image &img)
+{
+    if (!img.file.open(path) || img.file.size() < sizeof(header))
+        return false;
+    header h;
+    memcpy(&h, img.file.data(), sizeof(h));
+    if (memcmp(h.magic, "CKAT", 4) != 0 || h.version != FILE_VERSION || h.count != SPRITE_COUNT ||
+        img.file.size() != sizeof(header) + size_t(h.width) * h.height * 4)
+        return false;
+    img.width = int(h.width);
+    img.height = int(h.height);
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+        img.rects[i] = SDL_Rect{h.rects[i][0], h.rects[i][1], h.rects[i][2], h.rects[i][3]};
+    img.pixels = img.file.data() + sizeof(header);
+    return true;
+}
+
+// Пишет атлас во временный файл и заменяет им прежний: другой запущенный экземпляр игры может держать прежний
+// файл отображенным в память, и перезапись на месте обрезала бы ему страницы
+inline bool save(const string &path, const image &img)
+{
+    header h;
+    memcpy(h.magic, "CKAT", 4);
+    h.version = FILE_VERSION;
+    h.width = uint32_t(img.width);
+    h.height = uint32_t(img.height);
+    h.count = SPRITE_COUNT;
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        h.rects[i][0] = img.rects[i].x;
+        h.rects[i][1] = img.rects[i].y;
+        h.rects[i][2] = img.rects[i].w;
+        h.rects[i][3] = img.rects[i].h;
+    }
+    error_code ec;
+    const filesystem::path parent = filesystem::path(path).parent_path();
+    if (!parent.empty())
+        filesystem::create_directories(parent, ec);
+    const string tmp = path + ".tmp";
+    {
+        ofstream fout(tmp, ios::binary);
+        fout.write((const char *)&h, sizeof(h));
+        fout.write((const char *)img.pixels, size_t(img.width) * img.height * 4);
+        if (!fout.flush())
+        {
+            fout.close();
+            filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    filesystem::rename(tmp, path, ec);
+    if (ec)
+        filesystem::remove(tmp, ec);
+    return !ec;
+}
+
+// Каталог кэша пользователя: %LOCALAPPDATA%\checkers, ~/Library/Caches/checkers на macOS,
+// иначе $XDG_CACHE_HOME/checkers или ~/.cache/checkers. Пустая строка - переменных окружения нет
+inline string user_cache_dir()
+{
+    auto env = [](const char *name) {
+        const char *value = getenv(name);
+        return string(value ? value : "");
+    };
+#if defined(_WIN32)
+    const string base = env("LOCALAPPDATA");
+    return base.empty() ? "" : (filesystem::path(base) / "checkers").string();
+#elif defined(__APPLE__)
+    const string home = env("HOME");
+    return home.empty() ? "" : (filesystem::path(home) / "Library" / "Caches" / "checkers").string();
+#else
+    const string xdg = env("XDG_CACHE_HOME"), home = env("HOME");
+    if (!xdg.empty())
+        return (filesystem::path(xdg) / "checkers").string();
+    return home.empty() ? "" : (filesystem::path(home) / ".cache" / "checkers").string();
+#endif
+}
+
+// Где искать атлас, по порядку: кэш пользователя, затем atlas.ckat рядом с картинками (запасной вариант, если
+// кэша нет или в него нельзя писать; туда же атлас можно положить при установке). Имя в кэше зависит от полного
+// пути каталога картинок, чтобы разные копии игры с разными картинками не брали чужой атлас
+inline vector<string> paths(const string &textures_dir)
+{
+    vector<string> res;
+    const string cache_dir = user_cache_dir();
+    if (!cache_dir.empty())
+    {
+        error_code ec;
+        auto dir = filesystem::absolute(textures_dir, ec);
+        const string key = (ec ? filesystem::path(textures_dir) : dir).lexically_normal().string();
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (const char c : key)
+        {
+            hash ^= uint8_t(c);
+            hash *= 0x100000001B3ull;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "atlas-%016llx.ckat", (unsigned long long)hash);
+        res.push_back((filesystem::path(cache_dir) / name).string());
+    }
+    res.push_back(textures_dir + "atlas.ckat");
+    return res;
+}
+
+// Атлас устарел, если какой-то PNG изменен позже него
+inline bool is_stale(const string &textures_dir, const string &atlas_path)
+{
+    error_code ec;
+    const auto atlas_time = filesystem::last_write_time(atlas_path, ec);
+    if (ec)
+        return true;
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        const auto png_time = filesystem::last_write_time(textures_dir + sources()[i].file, ec);
+        if (!ec && png_time > atlas_time)
+            return true;
+    }
+    return false;
+}
+
+// Собирает атлас из PNG: каждая картинка уменьшается до max_side и ставится на полку по убыванию высоты
+inline bool build(const string &textures_dir, image &img, string &error)
+{
+    vector<SDL_Surface *> surfaces(SPRITE_COUNT, nullptr);
+    auto free_all = [&]() {
+        for (auto *s : surfaces)
+            SDL_FreeSurface(s);
+    };
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        const string path = textures_dir + sources()[i].file;
+        SDL_Surface *loaded = IMG_Load(path.c_str());
+        if (!loaded)
+        {
+            error = "IMG_Load can't load " + path;
+            free_all();
+            return false;
+        }
+        const int side = max(loaded->w, loaded->h), max_side = sources()[i].max_side;
+        const int w = side > max_side ? loaded->w * max_side / side : loaded->w;
+        const int h = side > max_side ? loaded->h * max_side / side : loaded->h;
+        surfaces[i] = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surfaces[i])
+        {
+            error = string("SDL_CreateRGBSurfaceWithFormat: ") + SDL_GetError();
+            SDL_FreeSurface(loaded);
+            free_all();
+            return false;
+        }
+        // копируем альфа-канал как есть, без смешивания
+        SDL_SetSurfaceBlendMode(loaded, SDL_BLENDMODE_NONE);
+        SDL_BlitScaled(loaded, nullptr, surfaces[i], nullptr);
+        SDL_FreeSurface(loaded);
+        img.rects[i] = SDL_Rect{0, 0, w, h};
+    }
+
+    // раскладка полками
+    vector<int> order(SPRITE_COUNT);
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return img.rects[a].h > img.rects[b].h; });
+    int x = 0, y = 0, shelf_height = 0;
+    for (int i : order)
+    {
+        if (x + img.rects[i].w > WIDTH)
+        {
+            x = 0;
+            y += shelf_height;
+            shelf_height = 0;
+        }
+        img.rects[i].x = x;
+        img.rects[i].y = y;
+        x += img.rects[i].w;
+        shelf_height = max(shelf_height, img.rects[i].h);
+    }
+    img.width = WIDTH;
+    img.height = y + shelf_height;
+
+    img.buffer.assign(size_t(img.width) * img.height * 4, 0);
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        SDL_Surface *s = surfaces[i];
+        SDL_LockSurface(s);
+        for (int row = 0; row < s->h; ++row)
+            memcpy(&img.buffer[(size_t(img.rects[i].y + row) * img.width + img.rects[i].x) * 4],
+                   (const uint8_t *)s->pixels + size_t(row) * s->pitch, size_t(s->w) * 4);
+        SDL_UnlockSurface(s);
+    }
+    free_all();
+    img.pixels = img.buffer.data();
+    return true;
+}
+
+// Одна текстура со всеми картинками
+inline SDL_Texture *create_texture(SDL_Renderer *ren, const image &img)
+{
+    SDL_Texture *tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, img.width, img.height);
+    if (!tex)
+        return nullptr;
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    if (SDL_UpdateTexture(tex, nullptr, img.pixels, img.width * 4) != 0)
+    {
+        SDL_DestroyTexture(tex);
+        return nullptr;
+    }
+    return tex;
+}
+} // namespace atlas
@@ -1,10 +1,17 @@
 #pragma once
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <vector>
 
+#include "../Engine/Geometry.h"
+#include "../Engine/Journal.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Position.h"
 #include "../Models/Move.h"
 #include "../Models/Project_path.h"
+#include "Animation.h"
+#include "Atlas.h"
 
 #ifdef __APPLE__
     #include <SDL.h>
@@ -19,10 +26,14 @@ using namespace std;
 class Board
 {
 public:
+    // Клеток по стороне доски; окно делится на CELLS частей: доска и поля по одной клетке с каждой стороны
+    static constexpr int SIZE = board_geometry<8>::SIZE;
+    static constexpr int CELLS = SIZE + 2;
+
     Board() = default; // Конструктор по умолчанию
 
     // Конструктор, инициализирующий ширину (W) и высоту (H) доски
-    Board(const unsigned int W, const unsigned int H) : W(W), H(H)
+    Board(const unsigned int W, const unsigned int H, Logger *logger) : W(W), H(H), logger(logger)
     {
     }
 
@@ -68,21 +79,9 @@ public:
             return 1; // Ошибка создания рендерера
         }
 
-        // Загружаем текстуры для доски, шашек и кнопок
-        board = IMG_LoadTexture(ren, board_path.c_str());
-        w_piece = IMG_LoadTexture(ren, piece_white_path.c_str());
-        b_piece = IMG_LoadTexture(ren, piece_black_path.c_str());
-        w_queen = IMG_LoadTexture(ren, queen_white_path.c_str());
-        b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
-        back = IMG_LoadTexture(ren, back_path.c_str());
-        replay = IMG_LoadTexture(ren, replay_path.c_str());
-
-        // Проверяем, удалось ли загрузить все текстуры
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
-        {
-            print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
+        // Загружаем атлас со всеми картинками одной текстурой (при первом запуске он собирается из PNG)
+        if (!load_atlas())
             return 1; // Ошибка загрузки текстур
-        }
 
         // Получаем окончательный размер окна
         SDL_GetRendererOutputSize(ren, &W, &H);
@@ -90,8 +89,8 @@ public:
         // Создаем начальную матрицу игрового поля
         make_start_mtx();
 
-        // Перерисовываем игровую сцену
-        rerender();
+        // Рисуем игровую сцену сразу, дальше кадры рисует frame
+        render();
 
         return 0; // Успешный запуск
     }
@@ -102,23 +101,34 @@ public:
         history_mtx.clear(); // Очищаем историю состояния доски
         history_beat_series.clear(); // Очищаем историю серий побежденных фигур
         make_start_mtx(); // Пересоздаем начальное состояние доски
+        timeline.clear(); // Анимация прошлой партии больше не нужна
         clear_active(); // Убираем выделение активной клетки
         clear_highlight(); // Убираем все выделенные клетки
     }
 
-    void move_piece(move_pos turn, const int beat_series = 0)
+    // promote - становится ли фигура дамкой на этом шаге (решает Logic::promotes по правилам варианта).
+    // Доска меняется сразу, на экране шаг проигрывается анимацией после уже поставленных шагов и паузы gap_ms
+    void move_piece(move_pos turn, const bool promote, const int beat_series = 0, const uint32_t gap_ms = 0)
     {
+        piece_step step{ turn.x, turn.y, turn.x2, turn.y2, turn.xb, turn.yb, mtx[turn.x][turn.y], 0, 0, animation_ms };
+
         // Если фигура была побита (в начале хранящаяся в xb, yb), то ее нужно убрать с доски
         if (turn.xb != -1)
         {
+            step.beaten_type = mtx[turn.xb][turn.yb];
             mtx[turn.xb][turn.yb] = 0; // Убираем побитую фигуру с позиции
         }
 
         // Перемещаем фигуру с одной клетки на другую (используя другую версию функции)
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
+        move_piece(turn.x, turn.y, turn.x2, turn.y2, promote, beat_series);
+        if (journal)
+            journal->step(turn, promote, beat_series);
+        if (animation_ms)
+            timeline.push(step, SDL_GetTicks(), gap_ms);
     }
 
-    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
+    void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const bool promote,
+                    const int beat_series = 0)
     {
         // Проверяем, пуста ли целевая клетка
         if (mtx[i2][j2])
@@ -132,8 +142,8 @@ public:
             throw runtime_error("begin position is empty, can't move");
         }
 
-        // Если фигура дошла до последнего ряда (в зависимости от ее цвета), она становится дамкой
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
+        // Если фигура дошла до последнего ряда и правила это позволяют, она становится дамкой
+        if (promote)
             mtx[i][j] += 2; // Превращаем в дамку (прибавляем 2 к значению фигуры)
 
         // Перемещаем фигуру на целевую позицию
@@ -177,9 +187,9 @@ public:
     void clear_highlight()
     {
         // Очищаем все клетки от подсветки (устанавливаем флаг подсветки в 0)
-        for (POS_T i = 0; i < 8; ++i)
+        for (POS_T i = 0; i < SIZE; ++i)
         {
-            is_highlighted_[i].assign(8, 0); // Присваиваем каждой клетке значение 0 (не подсвечивается)
+            is_highlighted_[i].assign(SIZE, 0); // Присваиваем каждой клетке значение 0 (не подсвечивается)
         }
         rerender(); // Перерисовываем доску, чтобы очистить подсветку
     }
@@ -214,10 +224,19 @@ public:
             history_beat_series.pop_back(); // Удаляем количество ударов, связанное с этим ходом
         }
         mtx = *(history_mtx.rbegin()); // Восстанавливаем доску из последнего состояния истории
+        if (journal)
+            journal->rollback();
+        timeline.clear(); // Отмененные шаги не доигрываются
         clear_highlight(); // Очищаем подсветку
         clear_active(); // Очищаем активную клетку
     }
 
+    // Журнал, в который пишутся шаги и откаты (nullptr - не писать, например при восстановлении из него же)
+    void set_journal(GameJournal *j)
+    {
+        journal = j;
+    }
+
     void show_final(const int res)
     {
         game_results = res; // Сохраняем результат игры (результат может быть: победа, ничья или проигрыш)
@@ -231,16 +250,35 @@ public:
         rerender(); // Перерисовываем доску с учетом нового размера окна
     }
 
+    // Длительность анимации одного шага хода, 0 - фигуры переставляются сразу
+    void set_animation_ms(const uint32_t ms)
+    {
+        animation_ms = ms;
+    }
+
+    // Идет ли анимация ходов
+    bool animating() const
+    {
+        return timeline.active();
+    }
+
+    // Кадр: рисует сцену, если она изменилась или идет анимация. Вызывается из циклов ожидания ввода и бота,
+    // темп задает вертикальная синхронизация (SDL_RENDERER_PRESENTVSYNC), а не задержки
+    void frame()
+    {
+        const uint32_t now = SDL_GetTicks();
+        const bool had_steps = timeline.active();
+        timeline.update(now);
+        // после последнего шага нужен еще один кадр с фигурой на месте
+        if (!dirty && !had_steps)
+            return;
+        render(now);
+    }
+
     void quit()
     {
         // Освобождаем ресурсы, связанные с графическими объектами и окном
-        SDL_DestroyTexture(board); // Удаляем текстуру для фона доски
-        SDL_DestroyTexture(w_piece); // Удаляем текстуру для белых фигур
-        SDL_DestroyTexture(b_piece); // Удаляем текстуру для черных фигур
-        SDL_DestroyTexture(w_queen); // Удаляем текстуру для белых дам
-        SDL_DestroyTexture(b_queen); // Удаляем текстуру для черных дам
-        SDL_DestroyTexture(back); // Удаляем текстуру фона
-        SDL_DestroyTexture(replay); // Удаляем текстуру кнопки для воспроизведения
+        SDL_DestroyTexture(textures); // Удаляем текстуру атласа
         SDL_DestroyRenderer(ren); // Удаляем рендерер
         SDL_DestroyWindow(win); // Удаляем окно
         SDL_Quit(); // Завершаем работу с SDL
@@ -253,6 +291,61 @@ public:
     }
 
 private:
+    // Атлас отображается в память и загружается в видеопамять, после этого файл больше не нужен.
+    // Берется первый свежий атлас из atlas::paths; собранный заново сохраняется в первое место, куда можно писать
+    bool load_atlas()
+    {
+        const auto start = chrono::steady_clock::now();
+        const vector<string> atlas_paths = atlas::paths(textures_path);
+        atlas::image img;
+        bool built = true;
+        for (const auto &path : atlas_paths)
+        {
+            if (!atlas::is_stale(textures_path, path) && atlas::load(path, img))
+            {
+                built = false;
+                break;
+            }
+            img.file.close();
+        }
+        if (built)
+        {
+            string error;
+            if (!atlas::build(textures_path, img, error))
+            {
+                print_exception(error);
+                return false;
+            }
+            const bool saved = any_of(atlas_paths.begin(), atlas_paths.end(),
+                                      [&](const string &path) { return atlas::save(path, img); });
+            if (!saved && logger)
+            {
+                string tried;
+                for (const auto &path : atlas_paths)
+                    tried += (tried.empty() ? "" : ", ") + path;
+                logger->log("error", "", -1, 0,
+                            "can't save texture atlas to " + tried + ", PNG files will be decoded on every start");
+            }
+        }
+        textures = atlas::create_texture(ren, img);
+        if (!textures)
+        {
+            print_exception("SDL_CreateTexture can't create texture atlas");
+            return false;
+        }
+        copy(img.rects, img.rects + SPRITE_COUNT, sprites);
+        if (logger)
+            logger->log(built ? "atlas_built" : "atlas_loaded", "",
+                        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count(),
+                        int64_t(img.width) * img.height * 4);
+        return true;
+    }
+
+    void draw_sprite(const atlas_sprite sprite, const SDL_Rect *dst)
+    {
+        SDL_RenderCopy(ren, textures, &sprites[sprite], dst);
+    }
+
     void add_history(const int beat_series = 0)
     {
         history_mtx.push_back(mtx);
@@ -261,64 +354,68 @@ private:
     // function to make start matrix
     void make_start_mtx()
     {
-        for (POS_T i = 0; i < 8; ++i)
-        {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                mtx[i][j] = 0;
-                if (i < 3 && (i + j) % 2 == 1)
-                    mtx[i][j] = 2;
-                if (i > 4 && (i + j) % 2 == 1)
-                    mtx[i][j] = 1;
-            }
-        }
+        mtx = start_mtx();
         add_history();
     }
 
-    // function that re-draw all the textures
+    // scene changed: the next frame() draws it
     void rerender()
     {
+        dirty = true;
+    }
+
+    // piece of the given type at a (possibly fractional) cell
+    void draw_piece(const POS_T type, const double i, const double j)
+    {
+        int wpos = int(W * (j + 1) / CELLS) + W / (CELLS * 12);
+        int hpos = int(H * (i + 1) / CELLS) + H / (CELLS * 12);
+        SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
+
+        atlas_sprite piece_sprite;
+        if (type == 1)
+            piece_sprite = SPRITE_PIECE_WHITE;
+        else if (type == 2)
+            piece_sprite = SPRITE_PIECE_BLACK;
+        else if (type == 3)
+            piece_sprite = SPRITE_QUEEN_WHITE;
+        else
+            piece_sprite = SPRITE_QUEEN_BLACK;
+
+        draw_sprite(piece_sprite, &rect);
+    }
+
+    // function that draws all the textures
+    void render(const uint32_t now = SDL_GetTicks())
+    {
+        dirty = false;
+
         // draw board
         SDL_RenderClear(ren);
-        SDL_RenderCopy(ren, board, NULL, NULL);
+        draw_sprite(SPRITE_BOARD, NULL);
 
-        // draw pieces
-        for (POS_T i = 0; i < 8; ++i)
+        // draw pieces; pieces that are still moving are drawn by the timeline
+        for (POS_T i = 0; i < SIZE; ++i)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            for (POS_T j = 0; j < SIZE; ++j)
             {
-                if (!mtx[i][j])
-                    continue;
-                int wpos = W * (j + 1) / 10 + W / 120;
-                int hpos = H * (i + 1) / 10 + H / 120;
-                SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
-
-                SDL_Texture* piece_texture;
-                if (mtx[i][j] == 1)
-                    piece_texture = w_piece;
-                else if (mtx[i][j] == 2)
-                    piece_texture = b_piece;
-                else if (mtx[i][j] == 3)
-                    piece_texture = w_queen;
-                else
-                    piece_texture = b_queen;
-
-                SDL_RenderCopy(ren, piece_texture, NULL, &rect);
+                if (mtx[i][j] && !timeline.hides(i, j))
+                    draw_piece(mtx[i][j], i, j);
             }
         }
+        timeline.for_each_piece(now, [&](const POS_T type, const double i, const double j) { draw_piece(type, i, j); });
 
         // draw hilight
         SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
         const double scale = 2.5;
         SDL_RenderSetScale(ren, scale, scale);
-        for (POS_T i = 0; i < 8; ++i)
+        for (POS_T i = 0; i < SIZE; ++i)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            for (POS_T j = 0; j < SIZE; ++j)
             {
                 if (!is_highlighted_[i][j])
                     continue;
-                SDL_Rect cell{ int(W * (j + 1) / 10 / scale), int(H * (i + 1) / 10 / scale), int(W / 10 / scale),
-                              int(H / 10 / scale) };
+                SDL_Rect cell{ int(W * (j + 1) / CELLS / scale), int(H * (i + 1) / CELLS / scale), int(W / CELLS / scale),
+                              int(H / CELLS / scale) };
                 SDL_RenderDrawRect(ren, &cell);
             }
         }
@@ -327,48 +424,38 @@ private:
         if (active_x != -1)
         {
             SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
-            SDL_Rect active_cell{ int(W * (active_y + 1) / 10 / scale), int(H * (active_x + 1) / 10 / scale),
-                                 int(W / 10 / scale), int(H / 10 / scale) };
+            SDL_Rect active_cell{ int(W * (active_y + 1) / CELLS / scale), int(H * (active_x + 1) / CELLS / scale),
+                                 int(W / CELLS / scale), int(H / CELLS / scale) };
             SDL_RenderDrawRect(ren, &active_cell);
         }
         SDL_RenderSetScale(ren, 1, 1);
 
         // draw arrows
         SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, back, NULL, &rect_left);
+        draw_sprite(SPRITE_BACK, &rect_left);
         SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, replay, NULL, &replay_rect);
+        draw_sprite(SPRITE_REPLAY, &replay_rect);
 
         // draw result
         if (game_results != -1)
         {
-            string result_path = draw_path;
+            atlas_sprite result_sprite = SPRITE_DRAW;
             if (game_results == 1)
-                result_path = white_path;
+                result_sprite = SPRITE_WHITE_WINS;
             else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
+                result_sprite = SPRITE_BLACK_WINS;
             SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
+            draw_sprite(result_sprite, &res_rect);
         }
 
         SDL_RenderPresent(ren);
-        // next rows for mac os
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+        // next row for mac os: the window is updated only while events are pumped
+        SDL_PumpEvents();
     }
 
     void print_exception(const string& text) {
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Error: " << text << ". "<< SDL_GetError() << endl;
-        fout.close();
+        if (logger)
+            logger->log("error", "", -1, 0, text + ". " + SDL_GetError());
     }
 
   public:
@@ -378,37 +465,29 @@ private:
     vector<vector<vector<POS_T>>> history_mtx;
 
   private:
+    Logger *logger = nullptr;
+    GameJournal *journal = nullptr;
     SDL_Window *win = nullptr;
     SDL_Renderer *ren = nullptr;
-    // textures
-    SDL_Texture *board = nullptr;
-    SDL_Texture *w_piece = nullptr;
-    SDL_Texture *b_piece = nullptr;
-    SDL_Texture *w_queen = nullptr;
-    SDL_Texture *b_queen = nullptr;
-    SDL_Texture *back = nullptr;
-    SDL_Texture *replay = nullptr;
+    // all pictures in one texture and their rects in it
+    SDL_Texture *textures = nullptr;
+    SDL_Rect sprites[SPRITE_COUNT];
     // texture files names
     const string textures_path = project_path + "Textures/";
-    const string board_path = textures_path + "board.png";
-    const string piece_white_path = textures_path + "piece_white.png";
-    const string piece_black_path = textures_path + "piece_black.png";
-    const string queen_white_path = textures_path + "queen_white.png";
-    const string queen_black_path = textures_path + "queen_black.png";
-    const string white_path = textures_path + "white_wins.png";
-    const string black_path = textures_path + "black_wins.png";
-    const string draw_path = textures_path + "draw.png";
-    const string back_path = textures_path + "back.png";
-    const string replay_path = textures_path + "replay.png";
     // coordinates of chosen cell
     int active_x = -1, active_y = -1;
     // game result if exist
     int game_results = -1;
+    // the scene changed since the last frame
+    bool dirty = true;
+    // queued move steps and the duration of one step
+    Timeline timeline;
+    uint32_t animation_ms = 0;
     // matrix of possible moves
-    vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(8, vector<bool>(8, 0));
+    vector<vector<bool>> is_highlighted_ = vector<vector<bool>>(SIZE, vector<bool>(SIZE, 0));
     // matrix of possible moves
     // 1 - white, 2 - black, 3 - white queen, 4 - black queen
-    vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    vector<vector<POS_T>> mtx = vector<vector<POS_T>>(SIZE, vector<POS_T>(SIZE, 0));
     // series of beats for each move
     vector<int> history_beat_series;
 };
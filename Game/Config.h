@@ -3,6 +3,9 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "../Engine/Game_review.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Logic_settings.h"
 #include "../Models/Project_path.h"
 
 class Config
@@ -27,6 +30,69 @@ class Config
         return config[setting_dir][setting_name];
     }
 
+    // Настройки бота для Logic, который не зависит от json
+    logic_settings get_logic_settings() const
+    {
+        logic_settings settings;
+        settings.rules = config["Game"].value("Rules", string("Russian"));
+        settings.scoring_mode = config["Bot"]["BotScoringType"];
+        settings.optimization = config["Bot"]["Optimization"];
+        settings.no_random = config["Bot"]["NoRandom"];
+        settings.seed = config["Bot"].value("Seed", 0u);
+        settings.random_margin = config["Bot"].value("RandomMargin", 10);
+        const string weights_file = config["Bot"].value("EvalWeights", "");
+        if (!weights_file.empty())
+            settings.weights_path = project_path + weights_file;
+        settings.nnue_path = project_path + config["Bot"].value("NnueFile", "");
+        settings.tt_size_mb = config["Bot"].value("TTSizeMB", 16);
+        settings.tt_shared = config["Bot"].value("TTShared", "");
+        const string cache_file = config["Bot"].value("CacheFile", "");
+        if (!cache_file.empty())
+            settings.cache_path = project_path + cache_file;
+        settings.engine = config["Bot"].value("Engine", string("Minimax"));
+        settings.mcts_time_ms = config["Bot"].value("MctsTimeMS", 0);
+        settings.mcts_playouts = config["Bot"].value("MctsPlayouts", size_t(0));
+        settings.mcts_threads = config["Bot"].value("MctsThreads", 0u);
+        settings.mcts_pool_mb = config["Bot"].value("MctsPoolMB", size_t(64));
+        return settings;
+    }
+
+    // Разбор партии после ее окончания (раздел "Review"; без раздела - значения по умолчанию)
+    bool review_enabled() const
+    {
+        return config.value("Review", json::object()).value("Enabled", true);
+    }
+
+    review_settings get_review_settings() const
+    {
+        review_settings settings;
+        const json review = config.value("Review", json::object());
+        settings.level = review.value("BotLevel", settings.level);
+        settings.time_ms = review.value("TimeMS", settings.time_ms);
+        settings.top = review.value("Top", settings.top);
+        return settings;
+    }
+
+    // Файл журнала ходов для восстановления прерванной партии (раздел "Journal"); "" - журнал выключен
+    string get_journal_path() const
+    {
+        const json journal = config.value("Journal", json::object());
+        if (!journal.value("Enabled", true))
+            return "";
+        return project_path + journal.value("File", string("journal.ckj"));
+    }
+
+    // Настройки журнала (раздел "Log"; без раздела - значения по умолчанию)
+    logger_settings get_logger_settings() const
+    {
+        logger_settings settings;
+        const json log = config.value("Log", json::object());
+        settings.path = project_path + log.value("File", string("log.txt"));
+        settings.max_size_kb = log.value("MaxSizeKB", settings.max_size_kb);
+        settings.max_files = log.value("MaxFiles", settings.max_files);
+        return settings;
+    }
+
   private:
     json config;
 };
@@ -1,20 +1,31 @@
 ﻿#pragma once
+#include <atomic>
 #include <chrono>
+#include <future>
 #include <thread>
 
 #include "../Models/Project_path.h"
 #include "Board.h"
 #include "Config.h"
 #include "Hand.h"
-#include "Logic.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Position_history.h"
 
 class Game
 {
   public:
-    Game() : board(config("WindowSize", "Width"), config("WindowSize", "Hight")), hand(&board), logic(&board, &config)
+    Game()
+        : logger(config.get_logger_settings()), board(config("WindowSize", "Width"), config("WindowSize", "Hight"), &logger),
+          hand(&board), logic_config(config.get_logic_settings()), logic(make_logic(logic_config))
     {
-        ofstream fout(project_path + "log.txt", ios_base::trunc);
-        fout.close();
+        // Журнал ходов: прерванная партия продолжается при следующем запуске (см. resume)
+        const string journal_path = config.get_journal_path();
+        if (journal_path.empty())
+            return;
+        if (journal.open(journal_path))
+            board.set_journal(&journal);
+        else
+            logger.log("error", "", -1, 0, "can't open journal " + journal_path);
     }
 
     // to start checkers
@@ -26,8 +37,22 @@ class Game
         // Если это повтор игры (REPLAY), перезагружаем конфигурацию и обновляем игровое поле
         if (is_replay)
         {
-            logic = Logic(&board, &config);  // Создаём новый объект логики игры
-            config.reload();                 // Перезагружаем конфиг
+            config.reload();                             // Перезагружаем конфиг
+            // Логика пересоздается, только если поменялись настройки бота: иначе таблица транспозиций
+            // прошлых партий остается, и поиск начинается не с нуля. С заданным Seed таблица очищается,
+            // чтобы повтор сыграл ту же партию
+            const logic_settings settings = config.get_logic_settings();
+            if (settings != logic_config)
+            {
+                logic_config = settings;
+                logic = make_logic(logic_config);  // Создаём новый объект логики игры (правила из Game.Rules)
+            }
+            else
+            {
+                logic->new_game();
+                if (logic_config.seed)
+                    logic->clear_cache();
+            }
             board.redraw();                   // Перерисовываем доску
         }
         else
@@ -35,26 +60,53 @@ class Game
             board.start_draw();  // Начальная отрисовка доски
         }
 
+        const bool first_start = !is_replay;
         is_replay = false; // Сбрасываем флаг повтора игры
 
         int turn_num = -1;  // Номер текущего хода
         bool is_quit = false;  // Флаг выхода из игры
         const int Max_turns = config("Game", "MaxNumTurns");  // Получаем максимальное количество ходов из конфига
+        game_record record;  // Доски перед каждым ходом для разбора партии (откат хода их укорачивает)
+        // Ничья по правилам: троекратное повторение позиции или долгие ходы одними дамками (Rules::QUIET_DRAW_MOVES)
+        position_history positions(3, quiet_draw_turns(logic_config.rules));
+        bool is_draw = false;
+
+        // При запуске продолжаем партию, прерванную падением или перезапуском; новая партия начинает журнал заново
+        if (first_start)
+            turn_num = resume(record);
+        else
+            journal.reset();
+
+        board.set_animation_ms(config("Animation", "StepMS")); // Длительность анимации шага хода
 
         // 🔄 Основной игровой цикл
         while (++turn_num < Max_turns)
         {
             beat_series = 0;  // Обнуляем серию захватов
+            record.resize(turn_num);
+            record.push_back(board.get_board());
+            journal.turn(turn_num); // Доска согласована: с этого места партию можно восстановить
 
             // Находим доступные ходы для игрока (turn_num % 2 определяет, чей сейчас ход: 0 - белые, 1 - чёрные)
-            logic.find_turns(turn_num % 2);
+            logic->find_turns(turn_num % 2, board.get_board());
 
             // Если нет доступных ходов — выход из цикла
-            if (logic.turns.empty())
+            if (logic->turns.empty())
+                break;
+
+            positions.assign(record);
+            const string draw = positions.draw();
+            if (!draw.empty())
+            {
+                logger.log("draw", "", -1, turn_num, draw);
+                is_draw = true;
                 break;
+            }
+            // Поиск бота и подсказка не ведут партию по кругу: возврат в эти позиции для них - ничья
+            logic->history = positions.previous();
 
             // Получаем уровень сложности бота из конфига
-            logic.Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
+            logic->Max_depth = config("Bot", string((turn_num % 2) ? "Black" : "White") + string("BotLevel"));
 
             // Проверяем, управляется ли данный цвет игроком или ботом
             if (!config("Bot", string("Is") + string((turn_num % 2) ? "Black" : "White") + string("Bot")))
@@ -74,6 +126,7 @@ class Game
                 }
                 else if (resp == Response::BACK)  // Откат хода назад
                 {
+                    const int back_from = turn_num;
                     // Если бот сделал ход, откатываем два хода назад (игрока и бота)
                     if (config("Bot", string("Is") + string((1 - turn_num % 2) ? "Black" : "White") + string("Bot")) &&
                         !beat_series && board.history_mtx.size() > 2)
@@ -89,22 +142,41 @@ class Game
                     board.rollback();
                     --turn_num;
                     beat_series = 0;
+
+                    // Число отмененных ходов, чтобы партию из журнала можно было разобрать (см. read_logged_games)
+                    logger.log("back", "", -1, max(0, back_from - turn_num - 1));
+                }
+                else
+                {
+                    logger.log("player_turn", turns_to_string(player_turns));
                 }
             }
             else
             {
-                // Если ход делает бот
-                bot_turn(turn_num % 2);
+                // Если ход делает бот (пока он думал, окно могли закрыть или нажать "повтор")
+                auto resp = bot_turn(turn_num % 2);
+                if (resp == Response::QUIT)
+                {
+                    is_quit = true;
+                    break;
+                }
+                if (resp == Response::REPLAY)
+                {
+                    is_replay = true;
+                    break;
+                }
             }
         }
 
         // Засекаем время окончания игры
         auto end = chrono::steady_clock::now();
 
-        // Логируем время игры в файл
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Game time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        // Логируем время игры и число ходов
+        logger.log("game_end", "", chrono::duration_cast<chrono::microseconds>(end - start).count(), turn_num);
+
+        // Кэш поиска на диске (Bot.CacheFile): следующий запуск начнет с таблицы этой партии
+        if (!logic_config.cache_path.empty() && !logic->save_cache(logic_config.cache_path))
+            logger.log("error", "", -1, 0, "can't save search cache " + logic_config.cache_path);
 
         // Если был запрос на повтор игры — запускаем её заново
         if (is_replay)
@@ -114,9 +186,12 @@ class Game
         if (is_quit)
             return 0;
 
+        // Законченная партия не восстанавливается
+        journal.end();
+
         // Определяем результат игры
         int res = 2; // 2 - ничья или незавершённая игра
-        if (turn_num == Max_turns)
+        if (turn_num == Max_turns || is_draw)
         {
             res = 0; // Ничья
         }
@@ -128,9 +203,23 @@ class Game
         // Показываем финальный экран
         board.show_final(res);
 
+        // Пока показан финальный экран, партия разбирается в фоне; худшие ходы попадают в журнал
+        record.resize(turn_num);
+        record.push_back(board.get_board());
+        atomic<bool> stop_review{false};
+        thread review_thread;
+        if (config.review_enabled())
+            review_thread = thread(&Game::review, this, move(record), config.get_logic_settings(),
+                                   config.get_review_settings(), &stop_review);
+
         // Ожидаем реакции игрока (например, хочет ли он сыграть ещё раз)
         auto resp = hand.wait();
 
+        // Незаконченный разбор прерывается после текущей позиции
+        stop_review = true;
+        if (review_thread.joinable())
+            review_thread.join();
+
         // Если игрок хочет повторить игру — запускаем её заново
         if (resp == Response::REPLAY)
         {
@@ -142,57 +231,179 @@ class Game
     }
 
   private:
-    void bot_turn(const bool color)
+    // Разбор партии: событие blunder на каждый из худших ходов (value - потеря оценки), в конце - review_end
+    void review(const game_record record, const logic_settings settings, const review_settings rs,
+                const atomic<bool> *stop)
     {
-        // Засекаем время начала хода бота
         auto start = chrono::steady_clock::now();
+        try
+        {
+            const auto reviews = review_game(settings, record, rs, stop);
+            for (const auto &r : worst_moves(reviews, rs.top))
+                logger.log("blunder", turns_to_string(r.played), -1, r.loss(),
+                           "turn " + to_string(r.turn_num + 1) + ", score " + score_to_string(r.played_score) +
+                               ", best " + turns_to_string(r.best) + " " + score_to_string(r.best_score));
+            auto end = chrono::steady_clock::now();
+            logger.log("review_end", "", chrono::duration_cast<chrono::microseconds>(end - start).count(),
+                       int64_t(reviews.size()));
+        }
+        catch (const exception &e)
+        {
+            logger.log("error", "", -1, 0, string("review: ") + e.what());
+        }
+    }
 
-        // Получаем задержку в миллисекундах между ходами бота из конфигурации
-        auto delay_ms = config("Bot", "BotDelayMS");
+    // Восстанавливает незаконченную партию из журнала: шаги и откаты повторяются на доске до начала последнего
+    // записанного хода (его незаконченная серия взятий отбрасывается). Возвращает номер хода, после которого
+    // продолжается игра (-1 - журнала нет, он пуст или партия в нем закончена)
+    int resume(game_record &record)
+    {
+        auto start = chrono::steady_clock::now();
+        const auto records = journal.records();
+        size_t last = records.size();
+        for (size_t k = 0; k < records.size(); ++k)
+            if (records[k].kind == journal_record::TURN)
+                last = k;
+        if (last == records.size() || records[last].value <= 0 || records.back().kind == journal_record::END)
+        {
+            journal.reset();
+            return -1;
+        }
+
+        // Ходы партии для журнала событий, чтобы ее можно было разобрать (см. read_logged_games)
+        vector<vector<move_pos>> turns;
+        vector<move_pos> current;
+        board.set_journal(nullptr);
+        try
+        {
+            for (size_t k = 0; k <= last; ++k)
+            {
+                const journal_record &rec = records[k];
+                if (rec.kind == journal_record::STEP)
+                {
+                    for (const int8_t c : {rec.x, rec.y, rec.x2, rec.y2})
+                        if (c < 0 || c >= Board::SIZE)
+                            throw runtime_error("bad step in record " + to_string(k));
+                    move_pos turn(rec.x, rec.y, rec.x2, rec.y2, rec.xb, rec.yb);
+                    if ((turn.xb == -1) != (turn.yb == -1) || turn.xb >= Board::SIZE || turn.yb >= Board::SIZE)
+                        throw runtime_error("bad capture in record " + to_string(k));
+                    board.move_piece(turn, rec.promote, rec.value);
+                    current.push_back(turn);
+                }
+                else if (rec.kind == journal_record::ROLLBACK)
+                {
+                    board.rollback();
+                }
+                else if (rec.kind == journal_record::TURN)
+                {
+                    // ход закончен, если следующий ход идет за ним; откат уменьшает номер хода
+                    if (!current.empty() && size_t(rec.value) == turns.size() + 1)
+                        turns.push_back(current);
+                    turns.resize(min(turns.size(), size_t(rec.value)));
+                    current.clear();
+                    record.resize(rec.value);
+                    record.push_back(board.get_board());
+                }
+            }
+        }
+        catch (const exception &e)
+        {
+            logger.log("error", "", -1, 0, string("journal: ") + e.what());
+            board.redraw();
+            record.clear();
+            journal.reset();
+            board.set_journal(&journal);
+            return -1;
+        }
+        board.set_journal(&journal);
+        // последняя запись TURN повторится в начале цикла игры
+        journal.truncate(last);
 
-        // Запускаем новый поток, чтобы добавить задержку для бота. Это позволяет каждому ходу бота задерживаться на заданное время.
-        thread th(SDL_Delay, delay_ms);
+        for (const auto &turn : turns)
+            logger.log("resumed_turn", turns_to_string(turn));
+        auto end = chrono::steady_clock::now();
+        logger.log("resume", "", chrono::duration_cast<chrono::microseconds>(end - start).count(), records[last].value);
+        return records[last].value - 1;
+    }
 
-        // Находим лучшие ходы для бота с учетом его цвета (цвет передается как параметр)
-        auto turns = logic.find_best_turns(color);
+    Response bot_turn(const bool color)
+    {
+        // Засекаем время начала хода бота
+        auto start = chrono::steady_clock::now();
 
-        // Ожидаем завершения потока с задержкой
-        th.join();
+        // Получаем задержку в миллисекундах между ходами бота из конфигурации
+        const int delay_ms = config("Bot", "BotDelayMS");
 
-        bool is_first = true;
-        // Применяем ходы бота
-        for (auto turn : turns)
+        // Бот ищет ход в отдельном потоке, а этот поток рисует кадры анимации и обрабатывает события окна
+        auto search = async(launch::async, [this, color, mtx = board.get_board()]() {
+            return logic->find_best_turns(color, mtx);
+        });
+
+        // Ход показывается, когда поиск закончен, прошла задержка BotDelayMS и доиграна анимация прошлого хода
+        Response resp = Response::OK;
+        while (search.wait_for(chrono::seconds(0)) != future_status::ready ||
+               chrono::steady_clock::now() - start < chrono::milliseconds(delay_ms) || board.animating())
         {
-            // Для каждого хода (кроме первого) добавляем задержку
-            if (!is_first)
+            resp = hand.pump();
+            if (resp != Response::OK)
             {
-                SDL_Delay(delay_ms);  // Задержка между ходами бота
+                // поиск нельзя прервать, но ждать задержку и анимацию уже незачем
+                search.wait();
+                break;
             }
+        }
+        auto turns = search.get();
+        if (resp != Response::OK)
+            return resp;
 
-            // После первого хода, флаг is_first будет false
-            is_first = false;
-
+        bool is_first = true;
+        // Применяем ходы бота: доска меняется сразу, шаги анимируются по очереди
+        for (auto turn : turns)
+        {
             // Увеличиваем серию "побежденных" фигур, если в ходе бота был съеденный фрагмент
             beat_series += (turn.xb != -1);
 
-            // Выполняем ход бота на доске (передаем информацию о ходе и серии побежденных)
-            board.move_piece(turn, beat_series);
+            // Выполняем ход бота на доске; перед каждым шагом, кроме первого, на экране пауза BotDelayMS
+            board.move_piece(turn, logic->promotes(board.get_board(), turn), beat_series, is_first ? 0 : delay_ms);
+
+            // После первого хода, флаг is_first будет false
+            is_first = false;
         }
 
         // Засекаем время окончания хода бота
         auto end = chrono::steady_clock::now();
 
-        // Записываем время, которое бот потратил на этот ход, в лог-файл
-        ofstream fout(project_path + "log.txt", ios_base::app);
-        fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
-        fout.close();
+        // Записываем ход бота, время хода и число узлов поиска в журнал
+        logger.log("bot_turn", turns_to_string(turns), chrono::duration_cast<chrono::microseconds>(end - start).count(),
+                   int64_t(logic->nodes));
+        return Response::OK;
+    }
+
+    // Подсказка: подсвечиваем клетки лучших ходов (HintCount вариантов с уровнем бота этого цвета)
+    void show_hint(const bool color)
+    {
+        const size_t count = config("Bot", "HintCount");
+        auto lines = logic->find_best_lines(color, board.get_board(), count);
+
+        vector<pair<POS_T, POS_T>> cells;
+        for (const auto &line : lines)
+        {
+            cells.emplace_back(line.turns.front().x, line.turns.front().y);
+            for (const auto &turn : line.turns)
+                cells.emplace_back(turn.x2, turn.y2);
+        }
+        board.clear_highlight();
+        board.highlight_cells(cells);
+
+        // Поиск перезаписывает logic->turns, восстанавливаем ходы игрока
+        logic->find_turns(color, board.get_board());
     }
 
     Response player_turn(const bool color)
     {
         // Подсвечиваем возможные ходы для текущего игрока
         vector<pair<POS_T, POS_T>> cells;
-        for (auto turn : logic.turns)
+        for (auto turn : logic->turns)
         {
             cells.emplace_back(turn.x, turn.y);
         }
@@ -206,6 +417,15 @@ class Game
         while (true)
         {
             auto resp = hand.get_cell(); // Получаем ввод от игрока
+            if (get<0>(resp) == Response::HINT)
+            {
+                // Подсказка сбрасывает выбранную клетку
+                board.clear_active();
+                x = -1;
+                y = -1;
+                show_hint(color);
+                continue;
+            }
             if (get<0>(resp) != Response::CELL)
                 return get<0>(resp); // Если не клетка, возвращаем ответ (например, QUIT или REPLAY)
 
@@ -213,7 +433,7 @@ class Game
 
             // Проверяем, является ли клетка допустимой для хода
             bool is_correct = false;
-            for (auto turn : logic.turns)
+            for (auto turn : logic->turns)
             {
                 if (turn.x == cell.first && turn.y == cell.second)
                 {
@@ -252,7 +472,7 @@ class Game
             board.set_active(x, y);
 
             vector<pair<POS_T, POS_T>> cells2;
-            for (auto turn : logic.turns)
+            for (auto turn : logic->turns)
             {
                 if (turn.x == x && turn.y == y)
                 {
@@ -265,23 +485,26 @@ class Game
         // Очищаем подсветку и перемещаем фигуру
         board.clear_highlight();
         board.clear_active();
-        board.move_piece(pos, pos.xb != -1);
+        player_turns.assign(1, pos);
+        // Ход продолжается, если было взятие и превращение в дамку его не закончило (зависит от правил)
+        bool continues = logic->continues_capture(board.get_board(), pos);
+        board.move_piece(pos, logic->promotes(board.get_board(), pos), pos.xb != -1);
 
         // Если фигура не бьёт другую, завершаем ход
-        if (pos.xb == -1)
+        if (!continues)
             return Response::OK;
 
         // Если был выполнен удар, продолжаем серию взятий (beat_series)
         beat_series = 1;
-        while (true)
+        while (continues)
         {
-            logic.find_turns(pos.x2, pos.y2); // Ищем возможные последующие взятия
-            if (!logic.have_beats)
+            logic->find_turns(pos.x2, pos.y2, board.get_board()); // Ищем возможные последующие взятия
+            if (!logic->have_beats)
                 break; // Если больше нельзя бить, выходим из цикла
 
             // Подсвечиваем клетки, доступные для следующего удара
             vector<pair<POS_T, POS_T>> cells;
-            for (auto turn : logic.turns)
+            for (auto turn : logic->turns)
             {
                 cells.emplace_back(turn.x2, turn.y2);
             }
@@ -292,6 +515,8 @@ class Game
             while (true)
             {
                 auto resp = hand.get_cell();
+                if (get<0>(resp) == Response::HINT) // Во время серии взятий подсказка не показывается
+                    continue;
                 if (get<0>(resp) != Response::CELL)
                     return get<0>(resp); // Если не клетка, возвращаем соответствующий ответ
 
@@ -299,7 +524,7 @@ class Game
 
                 // Проверяем, является ли выбранный ход корректным
                 bool is_correct = false;
-                for (auto turn : logic.turns)
+                for (auto turn : logic->turns)
                 {
                     if (turn.x2 == cell.first && turn.y2 == cell.second)
                     {
@@ -317,7 +542,9 @@ class Game
                 board.clear_highlight();
                 board.clear_active();
                 beat_series += 1; // Увеличиваем серию взятий
-                board.move_piece(pos, beat_series);
+                player_turns.push_back(pos);
+                continues = logic->continues_capture(board.get_board(), pos);
+                board.move_piece(pos, logic->promotes(board.get_board(), pos), beat_series);
                 break; // Выходим из цикла ожидания
             }
         }
@@ -327,9 +554,13 @@ class Game
 
   private:
     Config config;
+    Logger logger;
+    GameJournal journal;
     Board board;
     Hand hand;
-    Logic logic;
+    logic_settings logic_config; // настройки, с которыми создана logic
+    unique_ptr<Logic> logic;
     int beat_series;
+    vector<move_pos> player_turns; // Шаги последнего хода игрока для журнала
     bool is_replay = false;
 };
@@ -24,7 +24,7 @@ public:
 
         while (true) // Бесконечный цикл ожидания событий
         {
-            if (SDL_PollEvent(&windowEvent)) // Проверяем, есть ли событие в очереди
+            if (next_event(windowEvent)) // Рисуем кадр и проверяем, есть ли событие в очереди
             {
                 switch (windowEvent.type) // Определяем тип события
                 {
@@ -37,8 +37,8 @@ public:
                     y = windowEvent.motion.y;
 
                     // Определяем клетку на доске по координатам
-                    xc = int(y / (board->H / 10) - 1);
-                    yc = int(x / (board->W / 10) - 1);
+                    xc = int(y / (board->H / Board::CELLS) - 1);
+                    yc = int(x / (board->W / Board::CELLS) - 1);
 
                     // Проверяем, была ли нажата кнопка "назад"
                     if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
@@ -46,12 +46,12 @@ public:
                         resp = Response::BACK;
                     }
                     // Проверяем, была ли нажата кнопка "повтор"
-                    else if (xc == -1 && yc == 8)
+                    else if (xc == -1 && yc == Board::SIZE)
                     {
                         resp = Response::REPLAY;
                     }
                     // Проверяем, попал ли пользователь в игровое поле
-                    else if (xc >= 0 && xc < 8 && yc >= 0 && yc < 8)
+                    else if (xc >= 0 && xc < Board::SIZE && yc >= 0 && yc < Board::SIZE)
                     {
                         resp = Response::CELL;
                     }
@@ -63,6 +63,13 @@ public:
                     }
                     break;
 
+                case SDL_KEYDOWN: // Клавиша H - подсказка лучших ходов
+                    if (windowEvent.key.keysym.sym == SDLK_h)
+                    {
+                        resp = Response::HINT;
+                    }
+                    break;
+
                 case SDL_WINDOWEVENT: // Обработчик событий окна
                     if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
                     {
@@ -87,7 +94,7 @@ public:
 
         while (true) // Бесконечный цикл ожидания событий
         {
-            if (SDL_PollEvent(&windowEvent)) // Проверяем, есть ли событие в очереди
+            if (next_event(windowEvent)) // Рисуем кадр и проверяем, есть ли событие в очереди
             {
                 switch (windowEvent.type) // Определяем тип события
                 {
@@ -102,11 +109,11 @@ public:
                 case SDL_MOUSEBUTTONDOWN: { // Обработчик клика мыши
                     int x = windowEvent.motion.x; // Получаем координаты клика
                     int y = windowEvent.motion.y;
-                    int xc = int(y / (board->H / 10) - 1);
-                    int yc = int(x / (board->W / 10) - 1);
+                    int xc = int(y / (board->H / Board::CELLS) - 1);
+                    int yc = int(x / (board->W / Board::CELLS) - 1);
 
                     // Проверяем, нажал ли пользователь кнопку "повтор"
-                    if (xc == -1 && yc == 8)
+                    if (xc == -1 && yc == Board::SIZE)
                         resp = Response::REPLAY;
                 }
                                         break;
@@ -119,6 +126,40 @@ public:
         return resp; // Возвращаем ответ
     }
 
+    // Кадр и одно событие окна, пока игра занята другим (бот думает, доигрывается анимация).
+    // Ждет не дольше одного кадра; закрытие окна и кнопка "повтор" возвращаются как QUIT и REPLAY,
+    // клики по доске пропускаются
+    Response pump() const
+    {
+        SDL_Event windowEvent;
+        if (!next_event(windowEvent))
+            return Response::OK;
+        if (windowEvent.type == SDL_QUIT)
+            return Response::QUIT;
+        if (windowEvent.type == SDL_WINDOWEVENT && windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+            board->reset_window_size();
+        if (windowEvent.type == SDL_MOUSEBUTTONDOWN)
+        {
+            int xc = int(windowEvent.motion.y / (board->H / Board::CELLS) - 1);
+            int yc = int(windowEvent.motion.x / (board->W / Board::CELLS) - 1);
+            if (xc == -1 && yc == Board::SIZE)
+                return Response::REPLAY;
+        }
+        return Response::OK;
+    }
+
 private:
+    // Рисует кадр доски и берет событие: во время анимации не ждет (темп задает vsync),
+    // иначе спит до события, но не дольше IDLE_WAIT_MS
+    bool next_event(SDL_Event& windowEvent) const
+    {
+        board->frame();
+        if (board->animating())
+            return SDL_PollEvent(&windowEvent);
+        return SDL_WaitEventTimeout(&windowEvent, IDLE_WAIT_MS);
+    }
+
+    static constexpr int IDLE_WAIT_MS = 10;
+
     Board* board; // Указатель на объект игрового поля (используется для вычислений координат)
 };
@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+
+#include "Move.h"
+
+// Вариант анализа позиции: ход (серия взятий), его оценка и главное продолжение
+struct analysis_line
+{
+    std::vector<move_pos> turns;           // ход из анализируемой позиции
+    int score = 0;                         // оценка в шкале Logic::calc_score (больше - лучше для ходящего)
+    int depth = 0;                         // уровень (Max_depth), на котором получена оценка
+    std::vector<std::vector<move_pos>> pv; // ожидаемое продолжение после хода, по одному ходу на элемент
+};
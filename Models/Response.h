@@ -6,5 +6,6 @@ enum class Response
     BACK, // Игрок хочет откатить ход назад
     REPLAY, // Игрок хочет перезапустить игру
     QUIT, // Игрок хочет выйти из игры
-    CELL // Выбранная клетка
+    CELL, // Выбранная клетка
+    HINT // Игрок просит подсказку (клавиша H)
 };
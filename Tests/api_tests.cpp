@@ -0,0 +1,88 @@
+// C ABI (checkers_api): движок создается, ходит, ищет и оценивает только через функции checkers.h
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "checkers.h"
+#include "check.h"
+
+using namespace std;
+
+TEST_CASE(api_round_trip)
+{
+    CHECK_EQ(checkers_api_version(), CHECKERS_API_VERSION);
+    checkers_config config;
+    checkers_config_init(&config);
+
+    // неизвестные правила: движка нет, причина в checkers_last_error
+    checkers_config bad = config;
+    bad.rules = "Chess";
+    CHECK(checkers_engine_create(&bad) == nullptr);
+    CHECK(strlen(checkers_last_error()) > 0);
+
+    checkers_engine *engine = checkers_engine_create(&config);
+    CHECK(engine != nullptr);
+    if (!engine)
+        return;
+
+    int8_t board[64];
+    CHECK_EQ(checkers_start_position(8, board), int(CHECKERS_OK));
+    CHECK_EQ(checkers_legal_moves(engine, board, 0, nullptr, 0), 7);
+    vector<checkers_move> moves(32);
+    CHECK_EQ(checkers_legal_moves(engine, board, 0, moves.data(), int32_t(moves.size())), 7);
+
+    // начальная расстановка симметрична
+    int32_t score = -1;
+    CHECK_EQ(checkers_evaluate(engine, board, 1, &score), int(CHECKERS_OK));
+    CHECK_EQ(score, 0);
+
+    checkers_limits limits = {4, 0};
+    checkers_line lines[3];
+    uint64_t nodes = 0;
+    CHECK_EQ(checkers_search(engine, board, 0, &limits, lines, 3, &nodes), 3);
+    CHECK(nodes > 0);
+    CHECK(lines[0].score >= lines[1].score && lines[1].score >= lines[2].score);
+    CHECK_EQ(lines[0].depth, 4);
+    bool legal = false;
+    for (int k = 0; k < 7; ++k)
+        legal |= memcmp(&moves[k], &lines[0].move, sizeof(checkers_move)) == 0;
+    CHECK(legal);
+
+    // поиск детерминирован: после очистки таблицы - тот же ход с той же оценкой
+    checkers_line again;
+    CHECK_EQ(checkers_engine_clear(engine), int(CHECKERS_OK));
+    CHECK_EQ(checkers_search(engine, board, 0, &limits, &again, 1, nullptr), 1);
+    CHECK(memcmp(&again.move, &lines[0].move, sizeof(checkers_move)) == 0);
+    CHECK_EQ(again.score, lines[0].score);
+
+    // ход лучшего варианта, затем ход не по правилам
+    int8_t after[64];
+    memcpy(after, board, sizeof(board));
+    CHECK_EQ(checkers_apply_move(engine, after, 0, &lines[0].move), int(CHECKERS_OK));
+    CHECK(memcmp(after, board, sizeof(board)) != 0);
+    CHECK_EQ(checkers_apply_move(engine, after, 0, &lines[0].move), int(CHECKERS_ERROR_ARGUMENT));
+    CHECK(string(checkers_last_error()).find("not legal") != string::npos);
+
+    // оценка масками совпадает с оценкой досок
+    int8_t boards[128];
+    memcpy(boards, board, sizeof(board));
+    memcpy(boards + 64, after, sizeof(after));
+    checkers_packed packed[2];
+    CHECK_EQ(checkers_pack(board, &packed[0]), int(CHECKERS_OK));
+    CHECK_EQ(checkers_pack(after, &packed[1]), int(CHECKERS_OK));
+    int32_t by_board[2], by_mask[2];
+    CHECK_EQ(checkers_evaluate(engine, boards, 2, by_board), int(CHECKERS_OK));
+    CHECK_EQ(checkers_evaluate_packed(engine, packed, 2, by_mask, 1), int(CHECKERS_OK));
+    CHECK_EQ(by_board[0], by_mask[0]);
+    CHECK_EQ(by_board[1], by_mask[1]);
+    checkers_engine_destroy(engine);
+
+    // доска 10 x 10: у белых 9 ходов из начальной расстановки
+    config.size = 10;
+    checkers_engine *engine10 = checkers_engine_create(&config);
+    CHECK(engine10 != nullptr);
+    int8_t board10[100];
+    CHECK_EQ(checkers_start_position(10, board10), int(CHECKERS_OK));
+    CHECK_EQ(checkers_legal_moves(engine10, board10, 0, nullptr, 0), 9);
+    checkers_engine_destroy(engine10);
+}
@@ -0,0 +1,57 @@
+// Пакетная оценка: совпадает с Logic::calc_score на случайных расстановках для каждой оценки по весам
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Engine/Batch_eval.h"
+#include "../Engine/Logic.h"
+#include "check.h"
+
+using namespace std;
+
+// Случайная расстановка: на каждой темной клетке пусто, шашка или дамка; шашки не стоят на своем последнем ряду
+static vector<vector<POS_T>> random_mtx(mt19937 &rng)
+{
+    auto mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    for (int i = 0; i < 8; ++i)
+        for (int j = (i + 1) % 2; j < 8; j += 2)
+        {
+            const unsigned r = rng() % 16;
+            if (r < 4 && i != 0)
+                mtx[i][j] = 1;
+            else if (r < 8 && i != 7)
+                mtx[i][j] = 2;
+            else if (r == 8)
+                mtx[i][j] = 3;
+            else if (r == 9)
+                mtx[i][j] = 4;
+        }
+    return mtx;
+}
+
+// Позиций больше batch_eval::CHUNK, чтобы параллельная оценка разделила их между потоками
+TEST_CASE(batch_eval_matches_calc_score)
+{
+    mt19937 rng(5);
+    vector<vector<vector<POS_T>>> boards;
+    vector<packed_position> packed;
+    for (size_t k = 0; k < 2 * batch_eval::CHUNK + 77; ++k)
+    {
+        boards.push_back(random_mtx(rng));
+        packed.push_back(pack_position(boards.back()));
+    }
+    for (const string mode : {"NumberOnly", "NumberAndPotential"})
+    {
+        logic_settings settings;
+        settings.scoring_mode = mode;
+        const Logic8 logic(settings);
+        const eval_weights weights = eval_weights::preset(mode);
+        vector<int> single(packed.size()), parallel(packed.size());
+        evaluate_batch(weights, packed.data(), packed.size(), single.data());
+        evaluate_batch_parallel(weights, packed.data(), packed.size(), parallel.data(), 3);
+        size_t mismatches = 0;
+        for (size_t k = 0; k < packed.size(); ++k)
+            mismatches += single[k] != logic.calc_score(boards[k], 0) || parallel[k] != single[k];
+        CHECK_EQ(mismatches, size_t(0));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+// Проверки для ctest: TEST_CASE(имя) регистрирует функцию проверки, CHECK и CHECK_EQ отмечают несовпавшие условия.
+// Каждая проверка - отдельный тест ctest (checkers_tests ИМЯ), файлы проверок разложены по частям движка.
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace std;
+
+using test_function = void (*)();
+
+inline map<string, test_function> &registered_tests()
+{
+    static map<string, test_function> tests;
+    return tests;
+}
+
+// Число несовпавших условий за весь запуск
+inline int &check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+struct test_registration
+{
+    test_registration(const char *name, const test_function test)
+    {
+        registered_tests()[name] = test;
+    }
+};
+
+#define TEST_CASE(name)                                                                                                \
+    static void name();                                                                                                \
+    static const test_registration name##_registration(#name, name);                                                   \
+    static void name()
+
+#define CHECK(cond) check_that((cond), #cond, __FILE__, __LINE__)
+#define CHECK_EQ(a, b) check_equal((a), (b), #a " == " #b, __FILE__, __LINE__)
+
+inline void check_that(const bool ok, const char *expr, const char *file, const int line)
+{
+    if (ok)
+        return;
+    ++check_failures();
+    cerr << file << ":" << line << ": failed " << expr << "\n";
+}
+
+template <class A, class B>
+void check_equal(const A &a, const B &b, const char *expr, const char *file, const int line)
+{
+    if (a == b)
+        return;
+    ++check_failures();
+    cerr << file << ":" << line << ": failed " << expr << " (" << a << " vs " << b << ")\n";
+}
+
+// Временный файл в каталоге для временных файлов; удаляется в конце проверки
+inline string temp_path(const string &name)
+{
+    return (filesystem::temp_directory_path() / ("checkers_tests_" + name)).string();
+}
@@ -0,0 +1,75 @@
+// Ничья по правилам: повторение позиции и ходы одними дамками в партии и в поиске
+#include <string>
+#include <vector>
+
+#include "../Engine/Logic.h"
+#include "../Engine/Position_history.h"
+#include "../Engine/Rules.h"
+#include "check.h"
+
+using namespace std;
+
+// Троекратное повторение и ходы одними дамками в партии; в поиске возврат в позицию партии - ничья
+TEST_CASE(draw_rules)
+{
+    auto empty = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    auto a = empty, b = empty, c = empty, d = empty;
+    a[7][0] = 3, a[0][3] = 4; // ходят белые
+    b[6][1] = 3, b[0][3] = 4; // черные
+    c[6][1] = 3, c[1][4] = 4; // белые
+    d[7][0] = 3, d[1][4] = 4; // черные
+
+    position_history history(3, 0);
+    for (int cycle = 0; cycle < 2; ++cycle)
+        for (const auto *mtx : {&a, &b, &c, &d})
+        {
+            history.push(*mtx, mtx == &b || mtx == &d);
+            CHECK_EQ(history.draw(), string());
+        }
+    history.push(a, false);
+    CHECK_EQ(history.draw(), string("repetition"));
+
+    // ход шашкой обнуляет историю
+    auto man = a;
+    man[5][2] = 1;
+    auto man_moved = a;
+    man_moved[4][3] = 1;
+    CHECK(!position_history::reversible(man, man_moved));
+    CHECK(position_history::reversible(a, b));
+
+    position_history quiet(0, quiet_draw_turns("Russian"));
+    CHECK_EQ(quiet_draw_turns("Russian"), 30);
+    for (int t = 0; t < 30; ++t)
+    {
+        quiet.push(t % 2 ? b : a, t % 2);
+        CHECK_EQ(quiet.draw(), string());
+    }
+    quiet.push(a, false);
+    CHECK_EQ(quiet.draw(), string("quiet_moves"));
+
+    // две белые дамки против одной: ход, после которого черные повторяют позицию партии, оценивается нулем
+    auto h0 = empty, h1 = empty, root = empty;
+    h0[6][1] = 3, h0[5][6] = 3, h0[0][3] = 4;
+    h1[7][0] = 3, h1[5][6] = 3, h1[0][3] = 4;
+    root[7][0] = 3, root[5][6] = 3, root[1][4] = 4;
+    logic_settings settings;
+    settings.no_random = true;
+    Logic8 logic(settings);
+    logic.Max_depth = 6;
+    auto score_of = [&](const move_pos &turn) {
+        for (const auto &line : logic.find_best_lines(false, root, 30))
+            if (line.turns[0] == turn)
+                return line.score;
+        return -INF;
+    };
+    CHECK(score_of(move_pos(7, 0, 6, 1)) > 0);
+    // оценка без истории осталась бы в таблице транспозиций
+    logic.new_game();
+    logic.clear_cache();
+    logic.history = {h0, h1};
+    CHECK_EQ(score_of(move_pos(7, 0, 6, 1)), 0);
+    CHECK(score_of(move_pos(7, 0, 4, 3)) > 0);
+    // ничья из-за истории не остается в таблице: в новой партии без истории ход снова выигрывает
+    logic.new_game();
+    CHECK(score_of(move_pos(7, 0, 6, 1)) > 0);
+}
@@ -0,0 +1,57 @@
+// Журнал партии: восстановление после поврежденной или обрезанной записи
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../Engine/Journal.h"
+#include "check.h"
+
+using namespace std;
+
+// Поврежденная или обрезанная запись журнала: восстанавливаются записи до нее, дальше журнал пишется заново
+TEST_CASE(journal_recovery)
+{
+    const string path = temp_path("journal.ckj");
+    remove(path.c_str());
+    {
+        GameJournal journal;
+        CHECK(journal.open(path));
+        journal.turn(0);
+        journal.step(move_pos(5, 0, 4, 1), false, 0);
+        journal.turn(1);
+        journal.step(move_pos(2, 1, 3, 2), false, 0);
+        journal.turn(2);
+        journal.sync();
+        CHECK_EQ(journal.records().size(), size_t(5));
+    }
+    {
+        // порча байта в четвертой записи
+        fstream f(path, ios::in | ios::out | ios::binary);
+        f.seekp(sizeof(journal_header) + 3 * sizeof(journal_record) + 5);
+        f.put(char(0x7F));
+    }
+    {
+        GameJournal journal;
+        CHECK(journal.open(path));
+        const auto records = journal.records();
+        CHECK_EQ(records.size(), size_t(3));
+        CHECK_EQ(int(records[2].kind), int(journal_record::TURN));
+        CHECK_EQ(records[2].value, 1);
+        // запись после поврежденной не должна ожить, когда журнал дописывается
+        journal.step(move_pos(2, 3, 3, 4), false, 0);
+        journal.sync();
+    }
+    {
+        GameJournal journal;
+        CHECK(journal.open(path));
+        CHECK_EQ(journal.records().size(), size_t(4));
+    }
+    // файл обрезан посреди записи
+    filesystem::resize_file(path, sizeof(journal_header) + 2 * sizeof(journal_record) + 7);
+    {
+        GameJournal journal;
+        CHECK(journal.open(path));
+        CHECK_EQ(journal.records().size(), size_t(2));
+    }
+    remove(path.c_str());
+}
@@ -0,0 +1,62 @@
+// Поиск бота: повтор партии с тем же Seed и таблица транспозиций между партиями
+#include <vector>
+
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+#include "check.h"
+
+using namespace std;
+
+// Партия бота со случайным выбором среди близких ходов; вместе с ходами - число узлов первого поиска
+static vector<move_pos> bot_game(Logic &logic, size_t *first_nodes = nullptr)
+{
+    vector<move_pos> played;
+    auto mtx = start_mtx(8);
+    for (int turn_num = 0; turn_num < 16; ++turn_num)
+    {
+        const auto turns = logic.find_best_turns(turn_num % 2, mtx);
+        if (first_nodes && turn_num == 0)
+            *first_nodes = logic.nodes;
+        if (turns.empty())
+            break;
+        for (const auto &turn : turns)
+            mtx = logic.make_turn(mtx, turn);
+        played.insert(played.end(), turns.begin(), turns.end());
+    }
+    return played;
+}
+
+// Повтор партии с тем же Seed: new_game возвращает генератор к началу и сохраняет таблицу транспозиций,
+// с очищенной таблицей партия повторяется ход в ход, в том числе после смены Seed
+TEST_CASE(seeded_replay)
+{
+    logic_settings settings;
+    settings.seed = 7;
+    settings.random_margin = 300;
+    Logic8 logic(settings);
+    logic.Max_depth = 4;
+    size_t cold = 0, warm = 0;
+    const auto first = bot_game(logic, &cold);
+
+    logic.new_game();
+    bot_game(logic, &warm);
+    CHECK(warm < cold);
+
+    logic.new_game();
+    logic.clear_cache();
+    CHECK(bot_game(logic) == first);
+
+    Logic8 fresh(settings);
+    fresh.Max_depth = 4;
+    CHECK(bot_game(fresh) == first);
+
+    // set_seed - как бот, созданный с этим Seed
+    settings.seed = 8;
+    Logic8 other(settings);
+    other.Max_depth = 4;
+    const auto second = bot_game(other);
+    fresh.set_seed(8);
+    fresh.new_game();
+    fresh.clear_cache();
+    CHECK(bot_game(fresh) == second);
+}
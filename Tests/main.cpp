@@ -0,0 +1,22 @@
+// Запуск проверок: checkers_tests ИМЯ - одна проверка, без имени - все подряд.
+// Код возврата 0 - проверки прошли, 1 - есть несовпавшие условия (они в stderr), 2 - нет такой проверки
+#include "check.h"
+
+int main(int argc, char **argv)
+{
+    const auto &tests = registered_tests();
+    if (argc > 1 && !tests.count(argv[1]))
+    {
+        cerr << "unknown test " << argv[1] << "\n";
+        return 2;
+    }
+    for (const auto &[name, test] : tests)
+    {
+        if (argc > 1 && name != argv[1])
+            continue;
+        const int before = check_failures();
+        test();
+        cout << (check_failures() == before ? "ok      " : "FAILED  ") << name << "\n";
+    }
+    return check_failures() ? 1 : 0;
+}
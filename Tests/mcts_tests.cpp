@@ -0,0 +1,51 @@
+// Поиск Монте-Карло: ход из начальной позиции и повтор с заданным Seed при любом числе потоков
+#include <algorithm>
+#include <vector>
+
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+#include "check.h"
+
+using namespace std;
+
+static logic_settings mcts_settings(const unsigned seed, const unsigned threads)
+{
+    logic_settings settings;
+    settings.engine = "MCTS";
+    settings.seed = seed;
+    settings.mcts_threads = threads;
+    settings.mcts_playouts = 2000;
+    settings.mcts_pool_mb = 16;
+    return settings;
+}
+
+// Варианты корня - ходы позиции, поиск делает ровно заданное число доигрываний;
+// с Seed варианты одинаковы при одном и четырех потоках
+TEST_CASE(mcts_search)
+{
+    const auto mtx = start_mtx(8);
+    auto shared = make_logic(mcts_settings(0, 2));
+    const auto all = shared->find_all_turns(false, mtx);
+    const auto lines = shared->find_best_lines(false, mtx, all.size());
+    CHECK_EQ(lines.size(), all.size());
+    CHECK_EQ(shared->nodes, size_t(2000));
+    for (const auto &line : lines)
+        CHECK(find(all.begin(), all.end(), line.turns) != all.end());
+    CHECK(!lines[0].pv.empty());
+
+    auto single = make_logic(mcts_settings(11, 1));
+    auto multi = make_logic(mcts_settings(11, 4));
+    for (int search = 0; search < 2; ++search)
+    {
+        const auto a = single->find_best_lines(false, mtx, 3);
+        const auto b = multi->find_best_lines(false, mtx, 3);
+        CHECK_EQ(multi->nodes, size_t(2000));
+        CHECK_EQ(a.size(), b.size());
+        for (size_t i = 0; i < min(a.size(), b.size()); ++i)
+        {
+            CHECK(a[i].turns == b[i].turns);
+            CHECK_EQ(a[i].score, b[i].score);
+            CHECK(a[i].pv == b[i].pv);
+        }
+    }
+}
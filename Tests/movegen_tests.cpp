@@ -0,0 +1,47 @@
+// Генератор ходов: число ходов из начальной расстановки (perft) совпадает с известными для каждых правил
+#include <cstdint>
+#include <vector>
+
+#include "../Engine/Movegen.h"
+#include "../Engine/Position.h"
+#include "check.h"
+
+using namespace std;
+
+// Число полных ходов (серия взятий - один ход) на глубину depth
+template <class Rules> static uint64_t perft(const bit_position<8> &pos, const bool color, const int depth, const int from = -1)
+{
+    using gen = movegen<8, Rules>;
+    vector<move_pos> moves;
+    const bool beats = from != -1 ? gen::generate_from(pos, from, moves) : gen::generate(pos, color, moves);
+    if (from != -1 && !beats)
+        return depth == 1 ? 1 : perft<Rules>(pos, !color, depth - 1);
+    uint64_t res = 0;
+    for (const auto &turn : moves)
+    {
+        const auto next = gen::apply(pos, turn);
+        if (beats && gen::continues_capture(pos, turn))
+            res += perft<Rules>(next, color, depth, board_geometry<8>::square(turn.x2, turn.y2));
+        else
+            res += depth == 1 ? 1 : perft<Rules>(next, !color, depth - 1);
+    }
+    return res;
+}
+
+// Русские шашки: известные числа из начальной расстановки
+TEST_CASE(perft_russian)
+{
+    const uint64_t expected[] = {7, 49, 302, 1469, 7482, 37986, 190146};
+    const auto pos = bit_position<8>::from_mtx(start_mtx(8));
+    for (int depth = 1; depth <= 7; ++depth)
+        CHECK_EQ(perft<russian_rules>(pos, false, depth), expected[depth - 1]);
+}
+
+// Английские checkers: шашки не бьют назад, дамки ходят на одну клетку
+TEST_CASE(perft_english)
+{
+    const uint64_t expected[] = {7, 49, 302, 1469, 7361, 36768, 179740};
+    const auto pos = bit_position<8>::from_mtx(start_mtx(8));
+    for (int depth = 1; depth <= 7; ++depth)
+        CHECK_EQ(perft<english_rules>(pos, false, depth), expected[depth - 1]);
+}
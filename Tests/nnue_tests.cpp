@@ -0,0 +1,62 @@
+// Нейросеть оценки: инкрементальный аккумулятор совпадает с полным пересчетом
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../Engine/Movegen.h"
+#include "../Engine/Nnue.h"
+#include "../Engine/Position.h"
+#include "check.h"
+
+using namespace std;
+
+// Аккумулятор, обновляемый по ходам случайных партий, совпадает с пересчитанным с нуля
+TEST_CASE(nnue_incremental)
+{
+    auto net = make_unique<nnue_network>();
+    mt19937 rng(1);
+    for (auto &row : net->l1_w)
+        for (auto &w : row)
+            w = int16_t(int(rng() % 255) - 127);
+    for (auto &b : net->l1_b)
+        b = int16_t(int(rng() % 255) - 127);
+
+    using gen = movegen<8, russian_rules>;
+    for (int game = 0; game < 50; ++game)
+    {
+        auto pos = bit_position<8>::from_mtx(start_mtx(8));
+        nnue_accumulator acc;
+        acc.refresh(*net, pos);
+        bool color = false;
+        int from = -1;
+        vector<move_pos> moves;
+        for (int step = 0; step < 200; ++step)
+        {
+            const bool beats = from != -1 ? gen::generate_from(pos, from, moves) : gen::generate(pos, color, moves);
+            if (from != -1 && !beats)
+            {
+                from = -1;
+                color = !color;
+                continue;
+            }
+            if (moves.empty())
+                break;
+            const move_pos turn = moves[rng() % moves.size()];
+            const auto next = gen::apply(pos, turn);
+            acc.update(*net, pos, next);
+            from = beats && gen::continues_capture(pos, turn) ? board_geometry<8>::square(turn.x2, turn.y2) : -1;
+            if (from == -1)
+                color = !color;
+            pos = next;
+
+            nnue_accumulator full;
+            full.refresh(*net, pos);
+            CHECK(memcmp(acc.v, full.v, sizeof(acc.v)) == 0);
+            CHECK_EQ(acc.count[0], full.count[0]);
+            CHECK_EQ(acc.count[1], full.count[1]);
+            if (check_failures())
+                return;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// Решатель proof-number: точные результаты маленьких позиций и контрольные точки
+#include <filesystem>
+#include <string>
+
+#include "../Engine/Pn_search.h"
+#include "../Engine/Position.h"
+#include "check.h"
+
+using namespace std;
+
+// Контрольную точку некуда записать: решение доходит до предела времени, неудачи видны в результате
+TEST_CASE(pn_checkpoint_unwritable)
+{
+    const string dir = temp_path("no_such_dir");
+    filesystem::remove_all(dir);
+    pn_settings settings;
+    settings.tt_size_mb = 16;
+    settings.threads = 2;
+    settings.time_ms = 2500;
+    settings.checkpoint_sec = 1;
+    settings.checkpoint_path = dir + "/solve.ckpn";
+    pn_solver<8, russian_rules> solver(settings);
+    const pn_solution res = solver.solve(start_mtx(8), false);
+    CHECK_EQ(res.value, PN_UNKNOWN);
+    CHECK(res.nodes > 0);
+    // хотя бы одна запись из следящего потока при работающих потоках и одна в конце
+    CHECK(res.checkpoint_failures >= 2);
+    CHECK(res.checkpoint_error.find(settings.checkpoint_path) != string::npos);
+    CHECK(!filesystem::exists(dir));
+}
+
+// Белые забирают последнюю шашку черных: выигрыш этим взятием; у черных нет ходов - проигрыш;
+// одна дамка против одной - ничья
+TEST_CASE(pn_solved_values)
+{
+    auto win = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    win[4][3] = 1, win[3][2] = 2;
+    pn_settings settings;
+    settings.tt_size_mb = 16;
+    settings.threads = 2;
+    settings.max_plies = 20;
+    const pn_solution won = pn_solver<8, russian_rules>(settings).solve(win, false);
+    CHECK_EQ(won.value, PN_WIN);
+    CHECK(won.best == vector<move_pos>{move_pos(4, 3, 2, 1, 3, 2)});
+
+    // черной шашке некуда ходить: ее клетки впереди заняты белыми, бить за край доски нельзя
+    auto blocked = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    blocked[6][1] = 2, blocked[7][0] = 1, blocked[7][2] = 1;
+    const pn_solution lost = pn_solver<8, russian_rules>(settings).solve(blocked, true);
+    CHECK_EQ(lost.value, PN_LOSS);
+
+    auto draw = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    draw[7][2] = 3, draw[0][5] = 4;
+    const pn_solution drawn = pn_solver<8, russian_rules>(settings).solve(draw, false);
+    CHECK_EQ(drawn.value, PN_DRAW);
+    CHECK(drawn.nodes > 0);
+}
+
+// Три белые дамки ловят черную тихим ходом; если до позиции уже сделано 29 обратимых ходов,
+// тридцатый - ничья по правилу 15 ходов дамками, и выигрыша нет
+TEST_CASE(pn_quiet_draw)
+{
+    auto kings = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    kings[2][7] = 3, kings[4][1] = 3, kings[7][6] = 3, kings[0][5] = 4;
+    pn_settings settings;
+    settings.tt_size_mb = 16;
+    settings.threads = 1;
+    settings.max_plies = 8;
+    const pn_solution fresh = pn_solver<8, russian_rules>(settings).solve(kings, false);
+    CHECK_EQ(fresh.value, PN_WIN);
+    CHECK(!fresh.best.empty() && fresh.best[0].xb == -1);
+
+    settings.quiet_plies = 2 * russian_rules::QUIET_DRAW_MOVES - 1;
+    const pn_solution late = pn_solver<8, russian_rules>(settings).solve(kings, false);
+    CHECK_EQ(late.value, PN_DRAW);
+}
@@ -0,0 +1,123 @@
+// Таблица транспозиций: упаковка записей и файл кэша поиска
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../Engine/Transposition.h"
+#include "check.h"
+
+using namespace std;
+
+// Запись таблицы транспозиций читается такой же, какой записана; мелкая запись не вытесняет глубокую
+TEST_CASE(tt_round_trip)
+{
+    transposition_table tt;
+    tt.resize(1);
+    const move_pos capture(2, 3, 4, 5, 3, 4);
+    const move_pos quiet(9, 8, 8, 9);
+    tt.store(0x123456789ABCDEF0ull, capture, 12, -999985, TT_LOWER);
+    tt.store(0x0FEDCBA987654321ull, quiet, 1, 777, TT_EXACT);
+
+    tt_entry e;
+    CHECK(tt.probe(0x123456789ABCDEF0ull, e));
+    CHECK(e.move == capture);
+    CHECK_EQ(int(e.move.xb), 3);
+    CHECK_EQ(int(e.move.yb), 4);
+    CHECK_EQ(e.score, -999985);
+    CHECK_EQ(int(e.depth), 12);
+    CHECK_EQ(int(e.bound), int(TT_LOWER));
+
+    CHECK(tt.probe(0x0FEDCBA987654321ull, e));
+    CHECK(e.move == quiet);
+    CHECK_EQ(int(e.move.xb), -1);
+    CHECK_EQ(int(e.move.yb), -1);
+    CHECK_EQ(e.score, 777);
+
+    tt.store(0x123456789ABCDEF0ull, quiet, 3, 5, TT_UPPER);
+    CHECK(tt.probe(0x123456789ABCDEF0ull, e));
+    CHECK_EQ(int(e.depth), 12);
+    CHECK(!tt.probe(0x1111111111111111ull, e));
+
+    tt.clear();
+    CHECK(!tt.probe(0x123456789ABCDEF0ull, e));
+}
+
+// Файл таблицы: записи читаются обратно, запись с клетками вне доски пропускается, испорченный файл не читается
+TEST_CASE(tt_cache_file)
+{
+    const string path = temp_path("cache.cktt");
+    remove(path.c_str());
+    const uint64_t fingerprint = 0xC0FFEEull;
+    transposition_table tt;
+    tt.resize(1);
+    tt.store(1001, move_pos(2, 3, 4, 5, 3, 4), 7, -999985, TT_LOWER);
+    tt.store(1002, move_pos(5, 0, 4, 1), 3, 120, TT_EXACT);
+    tt.store(1003, move_pos(9, 8, 8, 9), 2, 40, TT_UPPER); // есть только на доске 10 x 10
+    CHECK(tt.save(path, fingerprint));
+    // второе сохранение заменяет файл
+    CHECK(tt.save(path, fingerprint));
+
+    transposition_table loaded;
+    loaded.resize(1);
+    CHECK_EQ(loaded.load(path, fingerprint, 8), size_t(2));
+    tt_entry e;
+    CHECK(loaded.probe(1001, e));
+    CHECK(e.move == move_pos(2, 3, 4, 5, 3, 4));
+    CHECK_EQ(e.score, -999985);
+    CHECK_EQ(int(e.depth), 7);
+    CHECK(!loaded.probe(1003, e));
+    CHECK_EQ(loaded.load(path, fingerprint + 1, 8), size_t(0));
+
+    transposition_table board10;
+    board10.resize(1);
+    CHECK_EQ(board10.load(path, fingerprint, 10), size_t(3));
+    CHECK(board10.probe(1003, e));
+
+    {
+        // порча байта оценки второй записи: контрольная сумма не сходится
+        fstream f(path, ios::in | ios::out | ios::binary);
+        f.seekp(sizeof(tt_file_header) + sizeof(tt_file_record) + 8);
+        f.put(char(0x55));
+    }
+    transposition_table corrupt;
+    corrupt.resize(1);
+    CHECK_EQ(corrupt.load(path, fingerprint, 10), size_t(0));
+    CHECK(!corrupt.probe(1001, e));
+
+    CHECK(tt.save(path, fingerprint));
+    filesystem::resize_file(path, sizeof(tt_file_header) + 2 * sizeof(tt_file_record));
+    CHECK_EQ(corrupt.load(path, fingerprint, 10), size_t(0));
+    remove(path.c_str());
+}
+
+#ifndef _WIN32
+// Общая таблица: второй подключенный видит записи первого, чужие правила и брошенный создателем
+// сегмент отказываются с причиной, называющей файл сегмента
+TEST_CASE(tt_shared_segment)
+{
+    const string name = "checkers_test_" + to_string(getpid());
+    string error;
+    transposition_table first, second, other;
+    CHECK(first.attach_shared(name, 1, 11, error));
+    CHECK(first.is_shared());
+    CHECK(second.attach_shared(name, 1, 11, error));
+    first.store(0x42, move_pos(2, 3, 3, 4), 5, 100, TT_EXACT);
+    tt_entry entry;
+    CHECK(second.probe(0x42, entry));
+    CHECK_EQ(entry.score, 100);
+    CHECK(!other.attach_shared(name, 1, 12, error));
+    CHECK(error.find("other rules") != string::npos);
+    shm_unlink(("/" + name).c_str());
+
+    // создатель задал размер, но не дописал заголовок
+    const string stale = name + "_stale";
+    const int fd = shm_open(("/" + stale).c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    CHECK(fd >= 0 && ftruncate(fd, off_t(TT_SHARED_OFFSET + 1024 * sizeof(tt_slot))) == 0);
+    close(fd);
+    CHECK(!other.attach_shared(stale, 1, 11, error));
+    CHECK(error.find("/dev/shm/" + stale) != string::npos);
+    CHECK(error.find("never initialized") != string::npos);
+    CHECK(!other.is_shared());
+    shm_unlink(("/" + stale).c_str());
+}
+#endif
@@ -0,0 +1,363 @@
+// Набор микробенчмарков для горячих функций Logic на фиксированном наборе позиций.
+// Выводит ns/op для генерации ходов, применения хода и оценки, а также узлы/сек поиска на фиксированных уровнях.
+// С --json результаты пишутся в файл, который можно сравнить с прошлым запуском через --compare.
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "../Engine/Batch_eval.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+
+struct bench_position
+{
+    string category; // opening, middlegame или endgame
+    string name;
+    bool color;      // чей ход: 0 - белые, 1 - черные
+    string mtx;
+};
+
+// Фиксированный набор позиций: менять только вместе с пометкой в истории, иначе сравнение между коммитами теряет смысл
+static const vector<bench_position> corpus = {
+    {"opening", "start", 0, ".b.b.b.b/b.b.b.b./.b.b.b.b/......../......../w.w.w.w./.w.w.w.w/w.w.w.w."},
+    {"opening", "c3-d4", 1, ".b.b.b.b/b.b.b.b./.b.b.b.b/......../...w..../w...w.w./.w.w.w.w/w.w.w.w."},
+    {"opening", "exchange", 0, ".b.b.b.b/b.b.b.b./.b...b.b/..b...../...w.w../w.....w./.w.w.w.w/w.w.w.w."},
+    {"middlegame", "balanced", 0, ".b.b...b/b...b.../.b.b.b../..b...../.w...w../w...w.w./.w...w.w/w......."},
+    {"middlegame", "white_king", 1, "...b.b../b.....b./.....b.b/b...w.../...b..../w.w...w./.....w.W/..w....."},
+    {"middlegame", "tension", 0, ".b.b.b../b.b...b./...b.b../..w.b.b./.w.w...w/w.....w./.w.w.w../w.w....."},
+    {"endgame", "kings_2v1", 0, ".......B/......../...b..../......../......../..W...../......../W......."},
+    {"endgame", "kings_3v1", 0, "......../B......./......../....W.../......../..W...../...W..../........"},
+    {"endgame", "kings_and_men", 1, ".W....../......../.b...b../......../...B..../w...w.../......../........"},
+};
+
+static const vector<int> search_levels = {2, 4, 6};
+
+struct bench_options
+{
+    double min_time_ms = 200;
+    int max_level = 6;
+    string json_path;
+    string compare_path;
+    string label;
+    logic_settings settings;
+};
+
+static volatile double sink;
+
+// Повторяет body, пока не наберется min_time_ms, возвращает ns на одну операцию
+template <class F> static double measure_ns(const bench_options &opt, const size_t ops_per_call, F body)
+{
+    size_t calls = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+    {
+        for (int k = 0; k < 16; ++k)
+            body();
+        calls += 16;
+        elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < opt.min_time_ms * 1e6);
+    return elapsed / double(calls * max<size_t>(ops_per_call, 1));
+}
+
+// Количество полных ходов (серия взятий - один ход) на глубину depth
+template <class L>
+static size_t perft(L &logic, const vector<vector<POS_T>> &mtx, const bool color, const int depth,
+                    const POS_T x = -1, const POS_T y = -1)
+{
+    if (x != -1)
+    {
+        logic.find_turns(x, y, mtx);
+        if (!logic.have_beats)
+            return depth == 1 ? 1 : perft(logic, mtx, 1 - color, depth - 1);
+    }
+    else
+    {
+        logic.find_turns(color, mtx);
+    }
+    const auto turns = logic.turns;
+    const bool has_beats = logic.have_beats;
+    size_t res = 0;
+    for (const auto &turn : turns)
+    {
+        const auto next = logic.make_turn(mtx, turn);
+        if (has_beats && logic.continues_capture(mtx, turn))
+            res += perft(logic, next, color, depth, turn.x2, turn.y2);
+        else
+            res += (depth == 1 ? 1 : perft(logic, next, 1 - color, depth - 1));
+    }
+    return res;
+}
+
+static void run_suite(const bench_options &opt, map<string, double> &metrics)
+{
+    Logic8 logic(opt.settings);
+
+    map<string, vector<pair<vector<vector<POS_T>>, bool>>> by_category;
+    for (const auto &pos : corpus)
+        by_category[pos.category].emplace_back(mtx_from_string(pos.mtx), pos.color);
+
+    for (const auto &[category, positions] : by_category)
+    {
+        // генерация ходов: одна операция - все ходы стороны в позиции
+        metrics["movegen." + category + ".ns_per_op"] = measure_ns(opt, positions.size(), [&]() {
+            for (const auto &[mtx, color] : positions)
+            {
+                logic.find_turns(color, mtx);
+                sink = double(logic.turns.size());
+            }
+        });
+
+        // применение хода: одна операция - один make_turn
+        vector<pair<vector<vector<POS_T>>, move_pos>> moves;
+        for (const auto &[mtx, color] : positions)
+        {
+            logic.find_turns(color, mtx);
+            for (const auto &turn : logic.turns)
+                moves.emplace_back(mtx, turn);
+        }
+        metrics["make_turn." + category + ".ns_per_op"] = measure_ns(opt, moves.size(), [&]() {
+            for (const auto &[mtx, turn] : moves)
+                sink = double(logic.make_turn(mtx, turn)[turn.x2][turn.y2]);
+        });
+
+        // оценка позиции
+        metrics["eval." + category + ".ns_per_op"] = measure_ns(opt, positions.size() * 2, [&]() {
+            for (const auto &[mtx, color] : positions)
+            {
+                sink = logic.calc_score(mtx, 0);
+                sink = logic.calc_score(mtx, 1);
+            }
+        });
+
+        // нейросеть: полный пересчет аккумулятора и обновление по ходу с оценкой
+        if (!opt.settings.nnue_path.empty())
+        {
+            nnue_network net;
+            net.load(opt.settings.nnue_path);
+            nnue_accumulator acc;
+            metrics["nnue." + category + ".refresh_ns_per_op"] = measure_ns(opt, positions.size(), [&]() {
+                for (const auto &[mtx, color] : positions)
+                {
+                    acc.refresh(net, mtx);
+                    sink = acc.count[0];
+                }
+            });
+            // как в поиске: аккумулятор обновляется по маскам позиции до и после шага
+            vector<nnue_accumulator> parents;
+            vector<pair<bit_position<8>, bit_position<8>>> steps;
+            for (const auto &[mtx, turn] : moves)
+            {
+                const auto before = bit_position<8>::from_mtx(mtx);
+                steps.emplace_back(before, movegen<8, russian_rules>::apply(before, turn));
+                parents.emplace_back();
+                parents.back().refresh(net, before);
+            }
+            metrics["nnue." + category + ".update_eval_ns_per_op"] = measure_ns(opt, steps.size(), [&]() {
+                for (size_t i = 0; i < steps.size(); ++i)
+                {
+                    acc = parents[i];
+                    acc.update(net, steps[i].first, steps[i].second);
+                    sink = acc.evaluate(net);
+                }
+            });
+        }
+
+        // поиск на фиксированных уровнях
+        for (int level : search_levels)
+        {
+            if (level > opt.max_level)
+                continue;
+            // свой объект логики, чтобы число узлов не зависело от предыдущих замеров
+            Logic8 search_logic(opt.settings);
+            search_logic.Max_depth = level;
+            size_t nodes = 0;
+            auto start = chrono::steady_clock::now();
+            for (const auto &[mtx, color] : positions)
+            {
+                search_logic.find_best_turns(color, mtx);
+                nodes += search_logic.nodes;
+            }
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            const string key = "search." + category + ".level" + to_string(level);
+            metrics[key + ".nodes"] = double(nodes);
+            metrics[key + ".nodes_per_sec"] = nodes / max(sec, 1e-9);
+        }
+
+        // выборочный поиск O2: узлы на тех же уровнях (сравнивать с search.*.nodes при --opt O1)
+        logic_settings selective = opt.settings;
+        selective.optimization = "O2";
+        for (int level : search_levels)
+        {
+            if (level > opt.max_level)
+                continue;
+            Logic8 search_logic(selective);
+            search_logic.Max_depth = level;
+            size_t nodes = 0;
+            for (const auto &[mtx, color] : positions)
+            {
+                search_logic.find_best_turns(color, mtx);
+                nodes += search_logic.nodes;
+            }
+            metrics["search_o2." + category + ".level" + to_string(level) + ".nodes"] = double(nodes);
+        }
+
+        // мульти-PV: узлы на 3 лучших хода относительно поиска одного лучшего
+        if (opt.max_level >= 4)
+        {
+            size_t nodes_single = 0, nodes_multi = 0;
+            for (const auto &[mtx, color] : positions)
+            {
+                Logic8 single(opt.settings), multi(opt.settings);
+                single.Max_depth = multi.Max_depth = 4;
+                single.find_best_lines(color, mtx, 1);
+                multi.find_best_lines(color, mtx, 3);
+                nodes_single += single.nodes;
+                nodes_multi += multi.nodes;
+            }
+            metrics["multipv." + category + ".level4.lines3_nodes"] = double(nodes_multi);
+            metrics["multipv." + category + ".level4.lines3_vs_single"] = double(nodes_multi) / max<size_t>(nodes_single, 1);
+        }
+    }
+
+    // пакетная оценка: позиции корпуса, размноженные до 64K, в одном потоке и на всех ядрах
+    vector<packed_position> packed;
+    while (packed.size() < 65536)
+        for (const auto &pos : corpus)
+            packed.push_back(pack_position(mtx_from_string(pos.mtx)));
+    vector<int> scores(packed.size());
+    const eval_weights weights = eval_weights::preset(opt.settings.scoring_mode);
+    metrics["batch_eval.ns_per_op"] = measure_ns(opt, packed.size(), [&]() {
+        evaluate_batch(weights, packed.data(), packed.size(), scores.data());
+        sink = scores[0];
+    });
+    metrics["batch_eval.parallel.ns_per_op"] = measure_ns(opt, packed.size(), [&]() {
+        evaluate_batch_parallel(weights, packed.data(), packed.size(), scores.data());
+        sink = scores[0];
+    });
+
+    // perft не зависит от скорости и ловит изменения правил генератора
+    for (const auto &pos : corpus)
+        metrics["perft." + pos.name + ".depth4"] = double(perft(logic, mtx_from_string(pos.mtx), pos.color, 4));
+
+    // доска 10 x 10: генерация ходов и perft из начальной расстановки (нейросеть только для 8 x 8, оценка здесь не нужна)
+    logic_settings settings10 = opt.settings;
+    settings10.scoring_mode = "NumberAndPotential";
+    Logic10 logic10(settings10);
+    const auto start10 = start_mtx(10);
+    metrics["movegen.board10.ns_per_op"] = measure_ns(opt, 1, [&]() {
+        logic10.find_turns(false, start10);
+        sink = double(logic10.turns.size());
+    });
+    metrics["perft.start10.depth4"] = double(perft(logic10, start10, 0, 4));
+
+    // другие правила: свой генератор для каждого варианта
+    BoardLogic<8, english_rules> english(opt.settings);
+    BoardLogic<8, brazilian_rules> brazilian(opt.settings);
+    for (const auto &pos : corpus)
+    {
+        const auto mtx = mtx_from_string(pos.mtx);
+        metrics["perft.english." + pos.name + ".depth4"] = double(perft(english, mtx, pos.color, 4));
+        metrics["perft.brazilian." + pos.name + ".depth4"] = double(perft(brazilian, mtx, pos.color, 4));
+    }
+}
+
+static void write_json(const bench_options &opt, const map<string, double> &metrics)
+{
+    ofstream fout(opt.json_path);
+    fout << "{\n  \"label\": \"" << opt.label << "\",\n  \"metrics\": {\n";
+    size_t i = 0;
+    for (const auto &[key, value] : metrics)
+        fout << "    \"" << key << "\": " << setprecision(10) << value << (++i < metrics.size() ? ",\n" : "\n");
+    fout << "  }\n}\n";
+}
+
+// Читает метрики из JSON, записанного write_json (плоский список "ключ": число)
+static map<string, double> read_json(const string &path)
+{
+    map<string, double> res;
+    ifstream fin(path);
+    string line;
+    while (getline(fin, line))
+    {
+        const auto q1 = line.find('"'), q2 = line.find('"', q1 + 1), colon = line.find(':', q2);
+        if (q1 == string::npos || q2 == string::npos || colon == string::npos)
+            continue;
+        istringstream value(line.substr(colon + 1));
+        double v;
+        if (value >> v)
+            res[line.substr(q1 + 1, q2 - q1 - 1)] = v;
+    }
+    return res;
+}
+
+static void print_metrics(const map<string, double> &metrics, const map<string, double> &baseline)
+{
+    for (const auto &[key, value] : metrics)
+    {
+        cout << left << setw(44) << key << right << setw(16) << fixed << setprecision(1) << value;
+        auto it = baseline.find(key);
+        if (it != baseline.end() && it->second != 0)
+            cout << "   " << showpos << setprecision(1) << (value / it->second - 1) * 100 << "%" << noshowpos;
+        cout << "\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bench_options opt;
+    opt.settings.no_random = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--max-level" && has_value)
+            opt.max_level = stoi(argv[++i]);
+        else if (arg == "--min-time-ms" && has_value)
+            opt.min_time_ms = stod(argv[++i]);
+        else if (arg == "--opt" && has_value)
+            opt.settings.optimization = argv[++i];
+        else if (arg == "--scoring" && has_value)
+            opt.settings.scoring_mode = argv[++i];
+        else if (arg == "--nnue" && has_value)
+            opt.settings.nnue_path = argv[++i];
+        else if (arg == "--json" && has_value)
+            opt.json_path = argv[++i];
+        else if (arg == "--compare" && has_value)
+            opt.compare_path = argv[++i];
+        else if (arg == "--label" && has_value)
+            opt.label = argv[++i];
+        else
+        {
+            cout << "Usage: checkers_bench [options]\n"
+                    "  --max-level N       highest search level to run (default 6)\n"
+                    "  --min-time-ms T     minimum time per ns/op measurement (default 200)\n"
+                    "  --opt LEVEL         O0, O1 or O2\n"
+                    "  --scoring TYPE      NumberOnly, NumberAndPotential or NNUE\n"
+                    "  --nnue FILE         network for NNUE scoring, also adds nnue.* metrics\n"
+                    "  --json FILE         write results as JSON\n"
+                    "  --compare FILE      show the change against a previous JSON result\n"
+                    "  --label TEXT        label stored in the JSON (e.g. commit hash)\n";
+            return 1;
+        }
+    }
+
+    if (!opt.settings.nnue_path.empty())
+        cout << "NNUE kernel: " << nnue_network::kernel_name() << "\n";
+
+    map<string, double> metrics;
+    run_suite(opt, metrics);
+
+    map<string, double> baseline;
+    if (!opt.compare_path.empty())
+        baseline = read_json(opt.compare_path);
+    print_metrics(metrics, baseline);
+
+    if (!opt.json_path.empty())
+        write_json(opt, metrics);
+    return 0;
+}
@@ -0,0 +1,537 @@
+// Консольный запуск партий бот против бота без SDL.
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "../Engine/Adjudication.h"
+#include "../Engine/Game_review.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Pn_search.h"
+#include "../Engine/Position.h"
+#include "../Engine/Position_history.h"
+
+struct cli_options
+{
+    logic_settings settings;
+    int white_level = 5;
+    int black_level = 0;
+    string white_opt; // оптимизация поиска для каждой стороны, пустая строка - --opt
+    string black_opt;
+    string white_engine; // движок каждой стороны, пустая строка - --engine
+    string black_engine;
+    int max_turns = 120;
+    int games = 1;
+    bool quiet = false;
+    string analyze;  // позиция для анализа (формат mtx_from_string), пустая строка - играть партии
+    bool analyze_color = 0;
+    size_t lines = 3;
+    string log_path; // журнал ходов и результатов в формате JSON lines, пустая строка - без журнала
+    int size = 8;    // размер доски: 8 или 10 (для --analyze берется из позиции)
+    string review_path; // журнал партий для разбора (--review), пустая строка - играть партии
+    review_settings review;
+    string solve;       // позиция для решателя (--solve) или "start", пустая строка - играть партии
+    string opening;     // ходы от начальной расстановки для --opening
+    int solve_plies = 0; // ходов до ничьей для решателя, 0 - --max-turns минус ходы дебюта
+    pn_settings solver;
+    adjudication_settings adjudication;
+};
+
+// Ctrl+C во время решения: решатель останавливается и сохраняет контрольную точку
+static atomic<bool> interrupted{false};
+
+extern "C" void on_interrupt(int)
+{
+    interrupted = true;
+}
+
+static void print_usage()
+{
+    cout << "Usage: checkers_cli [options]\n"
+            "  --white-level N     depth of the white bot (default 5)\n"
+            "  --black-level N     depth of the black bot (default 0)\n"
+            "  --scoring TYPE      NumberOnly, NumberAndPotential or NNUE\n"
+            "  --weights FILE      evaluation weights file (overrides --scoring)\n"
+            "  --nnue FILE         network file for --scoring NNUE\n"
+            "  --opt LEVEL         O0, O1 or O2\n"
+            "  --white-opt LEVEL   optimization of the white bot only (e.g. O1 against O2)\n"
+            "  --black-opt LEVEL   optimization of the black bot only\n"
+            "  --engine NAME       Minimax or MCTS (default Minimax)\n"
+            "  --white-engine NAME engine of the white bot only (e.g. MCTS against Minimax)\n"
+            "  --black-engine NAME engine of the black bot only\n"
+            "  --mcts-ms N         MCTS time per move (default: no limit)\n"
+            "  --mcts-playouts N   MCTS playouts per move (default: 2000 per level if --mcts-ms is not set)\n"
+            "  --mcts-threads N    MCTS threads (default: all cores)\n"
+            "  --no-random         deterministic bots\n"
+            "  --seed N            seed of the random move choice (default: clock); game N uses seed + N - 1\n"
+            "  --margin N          random moves are chosen within N of the best score (default 10)\n"
+            "  --max-turns N       turns before a draw (default 120)\n"
+            "  --games N           number of games (default 1)\n"
+            "  --quiet             print only game results\n"
+            "  --log FILE          write every move and game result to FILE (JSON lines)\n"
+            "  --tt-mb N           transposition table size in megabytes (default 16)\n"
+            "  --tt-shared NAME    share the transposition table with other processes through the shared\n"
+            "                      memory segment NAME (created with --tt-mb if missing)\n"
+            "  --cache FILE        load the transposition table from FILE at start and save it back after\n"
+            "                      the match and --analyze; the bots keep their tables between games\n"
+            "  --adjudicate        end decided games early: a score of 1500 for one side during 8 turns (win),\n"
+            "                      scores within 50 during 16 turns after turn 40, 3 repetitions or 15 turns\n"
+            "                      of king moves without captures (draw), solver result with 4 pieces or less;\n"
+            "                      every adjudication goes to --log\n"
+            "  --adj-score N       score threshold of the win rule (0 turns the rule off)\n"
+            "  --adj-turns N       turns the score must stay past the threshold (default 8)\n"
+            "  --adj-draw-score N  score bound of the draw rule (0 turns the rule off)\n"
+            "  --adj-draw-turns N  turns the score must stay within the bound (default 16)\n"
+            "  --adj-draw-after N  first turn of the draw rule (default 40)\n"
+            "  --adj-kings N       turns without captures and man moves for a draw (0 - off)\n"
+            "  --adj-repetition N  repetitions of a position for a draw (0 - off)\n"
+            "  --adj-pieces N      run the solver at N pieces or less (0 - off)\n"
+            "  --adj-nodes N       solver nodes per piece count (default 20000)\n"
+            "  --size 8|10         board size (default 8)\n"
+            "  --rules NAME        Russian, English or Brazilian (default Russian)\n"
+            "  --analyze POS       print the best lines for a position instead of playing,\n"
+            "                      POS is 8 or 10 rows like \".b.b.b.b/b.b.b.b./...\" (w/b - men, W/B - kings)\n"
+            "  --side white|black  side to move for --analyze (default white)\n"
+            "  --lines N           number of lines for --analyze (default 3)\n"
+            "  --review LOG        find the worst moves of every game in a --log file (or the GUI log)\n"
+            "                      instead of playing; --size and --rules must match the games\n"
+            "  --review-level N    search level for every position of --review (default 6)\n"
+            "  --review-ms N       time per position for --review: levels grow up to --review-level\n"
+            "  --threads N         search threads for --review and --solve (default: all cores)\n"
+            "  --top N             worst moves reported per game (default 3)\n"
+            "  --solve POS|start   prove the exact result of a position (side from --side) with the\n"
+            "                      proof-number solver instead of playing\n"
+            "  --opening MOVES     solve the position after MOVES from the start, e.g. \"c3-d4 f6-e5\"\n"
+            "  --solve-plies N     turns until a draw (default: --max-turns minus the --opening moves)\n"
+            "  --solve-mb N        solver table size in megabytes (default 256)\n"
+            "  --solve-nodes N     stop after about N nodes\n"
+            "  --solve-sec N       stop after N seconds\n"
+            "  --checkpoint FILE   save the solver table to FILE every --checkpoint-sec seconds and on exit\n"
+            "                      (Ctrl+C too); an existing FILE for the same position is resumed\n"
+            "  --checkpoint-sec N  checkpoint interval (default 60)\n";
+}
+
+static bool read_args(int argc, char *argv[], cli_options &opt)
+{
+    // --adj-* меняют настройки --adjudicate, где бы он ни стоял
+    for (int i = 1; i < argc; ++i)
+        if (string(argv[i]) == "--adjudicate")
+            opt.adjudication = adjudication_settings::defaults();
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--white-level" && has_value)
+            opt.white_level = stoi(argv[++i]);
+        else if (arg == "--black-level" && has_value)
+            opt.black_level = stoi(argv[++i]);
+        else if (arg == "--scoring" && has_value)
+            opt.settings.scoring_mode = argv[++i];
+        else if (arg == "--weights" && has_value)
+            opt.settings.weights_path = argv[++i];
+        else if (arg == "--nnue" && has_value)
+            opt.settings.nnue_path = argv[++i];
+        else if (arg == "--opt" && has_value)
+            opt.settings.optimization = argv[++i];
+        else if (arg == "--white-opt" && has_value)
+            opt.white_opt = argv[++i];
+        else if (arg == "--black-opt" && has_value)
+            opt.black_opt = argv[++i];
+        else if (arg == "--engine" && has_value)
+            opt.settings.engine = argv[++i];
+        else if (arg == "--white-engine" && has_value)
+            opt.white_engine = argv[++i];
+        else if (arg == "--black-engine" && has_value)
+            opt.black_engine = argv[++i];
+        else if (arg == "--mcts-ms" && has_value)
+            opt.settings.mcts_time_ms = stoi(argv[++i]);
+        else if (arg == "--mcts-playouts" && has_value)
+            opt.settings.mcts_playouts = stoul(argv[++i]);
+        else if (arg == "--mcts-threads" && has_value)
+            opt.settings.mcts_threads = unsigned(max(1, stoi(argv[++i])));
+        else if (arg == "--no-random")
+            opt.settings.no_random = true;
+        else if (arg == "--seed" && has_value)
+            opt.settings.seed = stoul(argv[++i]);
+        else if (arg == "--margin" && has_value)
+            opt.settings.random_margin = stoi(argv[++i]);
+        else if (arg == "--max-turns" && has_value)
+            opt.max_turns = stoi(argv[++i]);
+        else if (arg == "--games" && has_value)
+            opt.games = stoi(argv[++i]);
+        else if (arg == "--quiet")
+            opt.quiet = true;
+        else if (arg == "--log" && has_value)
+            opt.log_path = argv[++i];
+        else if (arg == "--tt-mb" && has_value)
+            opt.settings.tt_size_mb = stoul(argv[++i]);
+        else if (arg == "--tt-shared" && has_value)
+            opt.settings.tt_shared = argv[++i];
+        else if (arg == "--cache" && has_value)
+            opt.settings.cache_path = argv[++i];
+        else if (arg == "--adjudicate")
+            continue;
+        else if (arg == "--adj-score" && has_value)
+            opt.adjudication.win_score = stoi(argv[++i]);
+        else if (arg == "--adj-turns" && has_value)
+            opt.adjudication.win_turns = max(1, stoi(argv[++i]));
+        else if (arg == "--adj-draw-score" && has_value)
+            opt.adjudication.draw_score = stoi(argv[++i]);
+        else if (arg == "--adj-draw-turns" && has_value)
+            opt.adjudication.draw_turns = max(1, stoi(argv[++i]));
+        else if (arg == "--adj-draw-after" && has_value)
+            opt.adjudication.draw_after = stoi(argv[++i]);
+        else if (arg == "--adj-kings" && has_value)
+            opt.adjudication.king_draw_turns = stoi(argv[++i]);
+        else if (arg == "--adj-repetition" && has_value)
+            opt.adjudication.repetition = stoi(argv[++i]);
+        else if (arg == "--adj-pieces" && has_value)
+            opt.adjudication.solver_pieces = stoi(argv[++i]);
+        else if (arg == "--adj-nodes" && has_value)
+            opt.adjudication.solver_nodes = stoull(argv[++i]);
+        else if (arg == "--rules" && has_value)
+            opt.settings.rules = argv[++i];
+        else if (arg == "--size" && has_value)
+            opt.size = stoi(argv[++i]);
+        else if (arg == "--analyze" && has_value)
+            opt.analyze = argv[++i];
+        else if (arg == "--side" && has_value)
+            opt.analyze_color = string(argv[++i]) == "black";
+        else if (arg == "--lines" && has_value)
+            opt.lines = stoul(argv[++i]);
+        else if (arg == "--review" && has_value)
+            opt.review_path = argv[++i];
+        else if (arg == "--review-level" && has_value)
+            opt.review.level = stoi(argv[++i]);
+        else if (arg == "--review-ms" && has_value)
+            opt.review.time_ms = stoi(argv[++i]);
+        else if (arg == "--threads" && has_value)
+            opt.review.threads = opt.solver.threads = unsigned(max(1, stoi(argv[++i])));
+        else if (arg == "--top" && has_value)
+            opt.review.top = stoul(argv[++i]);
+        else if (arg == "--solve" && has_value)
+            opt.solve = argv[++i];
+        else if (arg == "--opening" && has_value)
+            opt.opening = argv[++i];
+        else if (arg == "--solve-plies" && has_value)
+            opt.solve_plies = stoi(argv[++i]);
+        else if (arg == "--solve-mb" && has_value)
+            opt.solver.tt_size_mb = stoul(argv[++i]);
+        else if (arg == "--solve-nodes" && has_value)
+            opt.solver.max_nodes = stoull(argv[++i]);
+        else if (arg == "--solve-sec" && has_value)
+            opt.solver.time_ms = stoi(argv[++i]) * 1000;
+        else if (arg == "--checkpoint" && has_value)
+            opt.solver.checkpoint_path = argv[++i];
+        else if (arg == "--checkpoint-sec" && has_value)
+            opt.solver.checkpoint_sec = stoi(argv[++i]);
+        else
+            return false;
+    }
+    if (!opt.opening.empty())
+        opt.solve = "start";
+    if (!opt.analyze.empty())
+        opt.size = int(mtx_from_string(opt.analyze).size());
+    if (!opt.solve.empty() && opt.solve != "start")
+        opt.size = int(mtx_from_string(opt.solve).size());
+    return opt.size == 8 || opt.size == 10;
+}
+
+// Нечисловое или слишком большое значение (stoi, stod) - ошибка аргументов, как неизвестный ключ: печатается справка
+static bool parse_args(int argc, char *argv[], cli_options &opt)
+{
+    try
+    {
+        return read_args(argc, argv, opt);
+    }
+    catch (const invalid_argument &)
+    {
+        return false;
+    }
+    catch (const out_of_range &)
+    {
+        return false;
+    }
+}
+
+// Играет одну партию, возвращает результат как Game::play: 0 - ничья, 1 - победа белых, 2 - победа черных.
+// logics[color] - бот стороны, к think_ms прибавляется время его поиска; adjudicator может закончить партию раньше
+template <int N>
+static int play_game(Logic *logics[2], const cli_options &opt, Logger *logger, double think_ms[2],
+                     Adjudicator<N> *adjudicator)
+{
+    auto mtx = start_mtx(N);
+    position_history positions(3, quiet_draw_turns(opt.settings.rules));
+    int turn_num = -1;
+    while (++turn_num < opt.max_turns)
+    {
+        const bool color = turn_num % 2;
+        auto &logic = *logics[color];
+        logic.find_turns(color, mtx);
+        if (logic.turns.empty())
+            break;
+
+        // ничья по правилам: троекратное повторение или долгие ходы одними дамками
+        positions.push(mtx, color);
+        const string draw = positions.draw();
+        if (!draw.empty())
+        {
+            if (logger)
+                logger->log("draw", "", -1, turn_num, draw);
+            return 0;
+        }
+        logic.history = positions.previous();
+
+        logic.Max_depth = color ? opt.black_level : opt.white_level;
+        auto start = chrono::steady_clock::now();
+        auto turns = logic.find_best_turns(color, mtx);
+        auto end = chrono::steady_clock::now();
+        think_ms[color] += chrono::duration<double, milli>(end - start).count();
+        for (const auto &turn : turns)
+            mtx = logic.make_turn(mtx, turn);
+
+        if (logger)
+            logger->log("bot_turn", turns_to_string(turns, N), chrono::duration_cast<chrono::microseconds>(end - start).count(),
+                        int64_t(logic.nodes));
+
+        if (!opt.quiet)
+            cout << turn_num + 1 << ". " << (color ? "black " : "white ") << turns_to_string(turns, N) << "\n";
+
+        if (adjudicator)
+        {
+            const int res = adjudicator->after_turn(mtx, color, logic.score, turn_num);
+            if (res >= 0)
+            {
+                if (logger)
+                    logger->log("adjudication", "", -1, res, adjudicator->reason());
+                return res;
+            }
+        }
+    }
+
+    if (turn_num == opt.max_turns)
+        return 0;
+    return turn_num % 2 ? 1 : 2;
+}
+
+// Лучшие варианты для позиции с оценкой и продолжением (уровень - --white-level или --black-level стороны хода)
+template <int N, class Rules> static void analyze(const cli_options &opt)
+{
+    auto bot = make_logic<N>(opt.settings);
+    Logic &logic = *bot;
+    logic.Max_depth = opt.analyze_color ? opt.black_level : opt.white_level;
+    auto start = chrono::steady_clock::now();
+    const auto lines = logic.find_best_lines(opt.analyze_color, mtx_from_string(opt.analyze), opt.lines);
+    auto end = chrono::steady_clock::now();
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        cout << i + 1 << ". " << turns_to_string(lines[i].turns, N) << "  score " << score_to_string(lines[i].score) << "  level "
+             << lines[i].depth << "  pv";
+        for (const auto &turns : lines[i].pv)
+            cout << " " << turns_to_string(turns, N);
+        cout << "\n";
+    }
+    cout << "Nodes: " << logic.nodes << ", " << (int)chrono::duration<double, milli>(end - start).count()
+         << " millisec\n";
+    if (!opt.settings.cache_path.empty() && !logic.save_cache(opt.settings.cache_path))
+        cout << "Can't save the cache to " << opt.settings.cache_path << "\n";
+}
+
+// Разбор партий из журнала: все позиции всех партий ищутся параллельно, для каждой партии печатаются худшие ходы
+template <int N, class Rules> static int review(const cli_options &opt)
+{
+    BoardLogic<N, Rules> logic(opt.settings);
+    const auto moves = read_logged_games(opt.review_path);
+    vector<game_record> games;
+    for (size_t g = 0; g < moves.size(); ++g)
+    {
+        games.emplace_back();
+        if (!record_from_moves(logic, moves[g], N, games.back()))
+            cout << "Game " << g + 1 << ": turn " << games.back().size() << " doesn't match the rules, "
+                 << "reviewing the turns before it\n";
+    }
+
+    auto start = chrono::steady_clock::now();
+    const auto reviews = review_games<N>(opt.settings, games, opt.review);
+    auto end = chrono::steady_clock::now();
+    size_t positions = 0;
+    for (size_t g = 0; g < games.size(); ++g)
+    {
+        positions += reviews[g].size();
+        cout << "Game " << g + 1 << ": " << games[g].size() - 1 << " turns\n";
+        for (const auto &r : worst_moves(reviews[g], opt.review.top))
+            cout << "  " << r.turn_num + 1 << ". " << (r.turn_num % 2 ? "black " : "white ") << turns_to_string(r.played, N)
+                 << "  score " << score_to_string(r.played_score) << ", best " << turns_to_string(r.best, N) << "  score "
+                 << score_to_string(r.best_score) << "  level " << r.depth << "\n";
+    }
+    cout << "Positions: " << positions << ", " << (int)chrono::duration<double, milli>(end - start).count()
+         << " millisec\n";
+    return 0;
+}
+
+// Точный результат позиции --solve или дебюта --opening: выигрыш, проигрыш или ничья для стороны хода
+template <int N, class Rules> static int solve(const cli_options &opt)
+{
+    auto mtx = opt.solve == "start" ? start_mtx(N) : mtx_from_string(opt.solve);
+    bool color = opt.analyze_color;
+    int played = 0;
+    if (!opt.opening.empty())
+    {
+        BoardLogic<N, Rules> logic(opt.settings);
+        vector<string> moves;
+        istringstream in(opt.opening);
+        for (string move; in >> move;)
+            moves.push_back(move);
+        game_record record;
+        if (!record_from_moves(logic, moves, N, record))
+        {
+            cout << "Error: opening move " << record.size() << " doesn't match the rules\n";
+            return 1;
+        }
+        mtx = record.back();
+        played = int(moves.size());
+        color = played % 2;
+    }
+
+    pn_settings settings = opt.solver;
+    settings.max_plies = opt.solve_plies > 0 ? opt.solve_plies : max(0, opt.max_turns - played);
+    pn_solver<N, Rules> solver(settings);
+    signal(SIGINT, on_interrupt);
+    auto start = chrono::steady_clock::now();
+    const pn_solution res = solver.solve(mtx, color, &interrupted);
+    auto end = chrono::steady_clock::now();
+    signal(SIGINT, SIG_DFL);
+
+    const char *side = color ? "black" : "white";
+    if (res.loaded)
+        cout << "Resumed from " << settings.checkpoint_path << ": " << res.loaded << " entries\n";
+    if (res.value == PN_WIN)
+        cout << "Result: " << side << " to move wins, move " << turns_to_string(res.best, N) << "\n";
+    else if (res.value == PN_LOSS)
+        cout << "Result: " << side << " to move loses\n";
+    else if (res.value == PN_DRAW)
+        cout << "Result: draw, neither side can force a win within " << settings.max_plies << " turns\n";
+    else
+        cout << "Result: unknown, stopped with proof number " << res.pn << ", disproof number " << res.dn
+             << (settings.checkpoint_path.empty() ? "" : ", continue with the same --checkpoint") << "\n";
+    cout << "Nodes: " << res.nodes << ", " << (int)chrono::duration<double, milli>(end - start).count()
+         << " millisec\n";
+    if (res.checkpoint_failures)
+        cout << "Warning: " << res.checkpoint_failures << " checkpoint save(s) failed, last: " << res.checkpoint_error
+             << "\n";
+    return res.value == PN_UNKNOWN ? 2 : 0;
+}
+
+// Анализ, разбор или серия партий на доске N x N по правилам Rules
+template <int N, class Rules> static int run(const cli_options &opt)
+{
+    // проверяем настройки (например, файл весов) до первой партии
+    try
+    {
+        BoardLogic<N, Rules> check(opt.settings);
+    }
+    catch (const exception &e)
+    {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (!opt.analyze.empty())
+    {
+        analyze<N, Rules>(opt);
+        return 0;
+    }
+    if (!opt.review_path.empty())
+        return review<N, Rules>(opt);
+    if (!opt.solve.empty())
+        return solve<N, Rules>(opt);
+
+    unique_ptr<Logger> logger;
+    if (!opt.log_path.empty())
+    {
+        logger_settings log_settings;
+        log_settings.path = opt.log_path;
+        logger = make_unique<Logger>(log_settings);
+    }
+
+    int results[3] = {0, 0, 0};
+    double think_ms[2] = {0, 0};
+    int adjudicated = 0;
+    unique_ptr<Adjudicator<N>> adjudicator;
+    if (opt.adjudication.enabled())
+        adjudicator = make_unique<Adjudicator<N>>(opt.adjudication, opt.settings.rules, opt.max_turns);
+    logic_settings white = opt.settings, black = opt.settings;
+    if (!opt.white_opt.empty())
+        white.optimization = opt.white_opt;
+    if (!opt.black_opt.empty())
+        black.optimization = opt.black_opt;
+    if (!opt.white_engine.empty())
+        white.engine = opt.white_engine;
+    if (!opt.black_engine.empty())
+        black.engine = opt.black_engine;
+    // боты создаются один раз: таблицы транспозиций (и кэш из файла) переходят из партии в партию
+    auto white_logic = make_logic<N>(white), black_logic = make_logic<N>(black);
+    Logic *logics[2] = {white_logic.get(), black_logic.get()};
+    for (int game = 0; game < opt.games; ++game)
+    {
+        for (Logic *logic : logics)
+        {
+            if (opt.settings.seed)
+                logic->set_seed(opt.settings.seed + game);
+            logic->new_game();
+        }
+        if (adjudicator)
+            adjudicator->new_game();
+        auto start = chrono::steady_clock::now();
+        const int res = play_game<N>(logics, opt, logger.get(), think_ms, adjudicator.get());
+        auto end = chrono::steady_clock::now();
+        ++results[res];
+        if (logger)
+            logger->log("game_end", "", chrono::duration_cast<chrono::microseconds>(end - start).count(), res);
+        const char *names[] = {"draw", "white wins", "black wins"};
+        cout << "Game " << game + 1 << ": " << names[res];
+        if (adjudicator && !adjudicator->reason().empty())
+        {
+            cout << " (adjudicated: " << adjudicator->reason() << ")";
+            ++adjudicated;
+        }
+        cout << ", " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+    }
+    // таблицы обоих ботов - в один файл кэша: черный добавляет к своей записи белого
+    if (!opt.settings.cache_path.empty())
+    {
+        white_logic->save_cache(opt.settings.cache_path);
+        black_logic->load_cache(opt.settings.cache_path);
+        black_logic->save_cache(opt.settings.cache_path);
+    }
+    cout << "White wins: " << results[1] << ", black wins: " << results[2] << ", draws: " << results[0] << "\n";
+    if (adjudicator)
+        cout << "Adjudicated: " << adjudicated << " of " << opt.games << "\n";
+    cout << "Search time: white " << (int)think_ms[0] << " millisec, black " << (int)think_ms[1] << " millisec\n";
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    cli_options opt;
+    if (!parse_args(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    try
+    {
+        return visit_rules(opt.settings.rules, [&](auto rules) {
+            return opt.size == 10 ? run<10, decltype(rules)>(opt) : run<8, decltype(rules)>(opt);
+        });
+    }
+    catch (const exception &e)
+    {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,263 @@
+// Генератор обучающих данных: партии бота с самим собой на всех ядрах со случайным дебютом.
+// Каждая позиция после дебюта записывается с оценкой поиска, лучшим ходом и результатом партии
+// в двоичном формате Engine/Selfplay_data.h, файлы делятся на шарды по --shard-positions записей.
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../Engine/Adjudication.h"
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+#include "../Engine/Position_history.h"
+#include "../Engine/Selfplay_data.h"
+
+struct selfplay_options
+{
+    logic_settings settings;
+    string out_prefix = "selfplay";
+    long long games = 0;       // 0 - без ограничения (до --positions)
+    long long positions = 0;   // 0 - без ограничения (до --games)
+    size_t shard_positions = 1 << 22;
+    int level = 3;
+    int random_plies = 8;
+    int max_turns = 120;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    unsigned seed = unsigned(time(0));
+    adjudication_settings adjudication;
+};
+
+// Записей в буфере потока до передачи в shard_writer (~1,5 МБ)
+const size_t THREAD_BUFFER = 1 << 16;
+
+static void print_usage()
+{
+    cout << "Usage: checkers_selfplay [--games N] [--positions N] [--out PREFIX] [--shard-positions N]\n"
+            "                         [--level N] [--random-plies N] [--max-turns N] [--threads N] [--seed N]\n"
+            "                         [--rules NAME] [--scoring TYPE] [--weights FILE] [--nnue FILE] [--opt LEVEL]\n"
+            "                         [--tt-mb N] [--adjudicate]\n"
+            "  --games N           games to play (default: until --positions)\n"
+            "  --positions N       stop after about N positions (default: until --games)\n"
+            "  --out PREFIX        shards are PREFIX-00000.ckd, PREFIX-00001.ckd, ... (default selfplay)\n"
+            "  --shard-positions N records per shard (default 4194304, 96 MB)\n"
+            "  --level N           search level of both sides (default 3)\n"
+            "  --random-plies N    random moves at the start of every game (default 8)\n"
+            "  --adjudicate        end decided games early (rules of checkers_cli --adjudicate),\n"
+            "                      the positions get the adjudicated result\n";
+}
+
+static bool read_args(int argc, char *argv[], selfplay_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--games" && has_value)
+            opt.games = stoll(argv[++i]);
+        else if (arg == "--positions" && has_value)
+            opt.positions = stoll(argv[++i]);
+        else if (arg == "--out" && has_value)
+            opt.out_prefix = argv[++i];
+        else if (arg == "--shard-positions" && has_value)
+            opt.shard_positions = stoull(argv[++i]);
+        else if (arg == "--level" && has_value)
+            opt.level = stoi(argv[++i]);
+        else if (arg == "--random-plies" && has_value)
+            opt.random_plies = stoi(argv[++i]);
+        else if (arg == "--max-turns" && has_value)
+            opt.max_turns = stoi(argv[++i]);
+        else if (arg == "--threads" && has_value)
+            opt.threads = unsigned(max(1, stoi(argv[++i])));
+        else if (arg == "--seed" && has_value)
+            opt.seed = unsigned(stoul(argv[++i]));
+        else if (arg == "--rules" && has_value)
+            opt.settings.rules = argv[++i];
+        else if (arg == "--scoring" && has_value)
+            opt.settings.scoring_mode = argv[++i];
+        else if (arg == "--weights" && has_value)
+            opt.settings.weights_path = argv[++i];
+        else if (arg == "--nnue" && has_value)
+            opt.settings.nnue_path = argv[++i];
+        else if (arg == "--opt" && has_value)
+            opt.settings.optimization = argv[++i];
+        else if (arg == "--tt-mb" && has_value)
+            opt.settings.tt_size_mb = stoul(argv[++i]);
+        else if (arg == "--adjudicate")
+            opt.adjudication = adjudication_settings::defaults();
+        else
+            return false;
+    }
+    // без ограничений генератор работал бы бесконечно
+    return opt.games > 0 || opt.positions > 0;
+}
+
+// Нечисловое или слишком большое значение - ошибка аргументов: печатается справка
+static bool parse_args(int argc, char *argv[], selfplay_options &opt)
+{
+    try
+    {
+        return read_args(argc, argv, opt);
+    }
+    catch (const invalid_argument &)
+    {
+        return false;
+    }
+    catch (const out_of_range &)
+    {
+        return false;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    selfplay_options opt;
+    if (!parse_args(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    opt.settings.no_random = true;
+    try
+    {
+        // проверяем правила и файлы оценки до запуска потоков
+        make_logic(opt.settings);
+        selfplay::shard_writer writer(opt.out_prefix, opt.shard_positions, opt.settings.rules);
+        atomic<long long> next_game{0};
+        atomic<long long> produced{0};
+        atomic<long long> played{0};
+        atomic<long long> adjudicated{0};
+        atomic<bool> failed{false};
+        string error;
+        mutex error_mutex;
+
+        auto worker = [&]() {
+            try
+            {
+                auto logic = make_logic(opt.settings);
+                logic->Max_depth = opt.level;
+                Adjudicator<8> adjudicator(opt.adjudication, opt.settings.rules, opt.max_turns);
+                position_history positions(3, quiet_draw_turns(opt.settings.rules));
+                vector<selfplay::record> buffer, game;
+                buffer.reserve(THREAD_BUFFER);
+                // ход (серия взятий - несколько шагов); память выделяется один раз на поток
+                vector<move_pos> turns;
+                turns.reserve(16);
+                while (!failed)
+                {
+                    const long long game_num = next_game++;
+                    if ((opt.games && game_num >= opt.games) || (opt.positions && produced >= opt.positions))
+                        break;
+                    // партия зависит только от своего номера, а не от потока: таблица транспозиций каждой
+                    // партии начинается пустой
+                    mt19937 rng(opt.seed + unsigned(game_num));
+                    logic->new_game();
+                    logic->clear_cache();
+                    auto mtx = start_mtx();
+                    game.clear();
+                    adjudicator.new_game();
+                    positions.clear();
+                    bool rule_draw = false;
+                    int adjudication = -1;
+                    int turn_num = -1;
+                    while (++turn_num < opt.max_turns)
+                    {
+                        const bool color = turn_num % 2;
+                        int score = Adjudicator<8>::NO_SCORE;
+                        // ничья по правилам: троекратное повторение или долгие ходы одними дамками
+                        positions.push(mtx, color);
+                        rule_draw = !positions.draw().empty();
+                        if (rule_draw)
+                            break;
+                        logic->history = positions.previous();
+                        if (turn_num < opt.random_plies)
+                        {
+                            const auto all = logic->find_all_turns(color, mtx);
+                            if (all.empty())
+                                break;
+                            const auto &chosen = all[rng() % all.size()];
+                            turns.assign(chosen.begin(), chosen.end());
+                        }
+                        else
+                        {
+                            const auto lines = logic->find_best_lines(color, mtx, 1);
+                            if (lines.empty())
+                                break;
+                            turns.assign(lines[0].turns.begin(), lines[0].turns.end());
+                            selfplay::record rec;
+                            rec.set_position(pack_position(mtx));
+                            rec.score = score = lines[0].score;
+                            rec.from = uint8_t(board_geometry<8>::square(turns.front().x, turns.front().y));
+                            rec.to = uint8_t(board_geometry<8>::square(turns.back().x2, turns.back().y2));
+                            rec.color = color;
+                            game.push_back(rec);
+                        }
+                        for (const auto &turn : turns)
+                            mtx = logic->make_turn(mtx, turn);
+                        if (opt.adjudication.enabled() &&
+                            (adjudication = adjudicator.after_turn(mtx, color, score, turn_num)) >= 0)
+                            break;
+                    }
+
+                    // ходов нет у стороны turn_num % 2 - она проиграла
+                    uint8_t result = turn_num == opt.max_turns || rule_draw ? selfplay::DRAW
+                                     : turn_num % 2            ? selfplay::WHITE_WINS
+                                                               : selfplay::BLACK_WINS;
+                    if (adjudication >= 0)
+                    {
+                        result = adjudication == 1 ? selfplay::WHITE_WINS
+                                 : adjudication == 2 ? selfplay::BLACK_WINS
+                                                     : selfplay::DRAW;
+                        ++adjudicated;
+                    }
+                    for (auto &rec : game)
+                    {
+                        rec.result = result;
+                        buffer.push_back(rec);
+                    }
+                    produced += game.size();
+                    ++played;
+                    if (buffer.size() >= THREAD_BUFFER)
+                    {
+                        writer.write(buffer);
+                        buffer.clear();
+                    }
+                }
+                writer.write(buffer);
+            }
+            catch (const exception &e)
+            {
+                failed = true;
+                lock_guard<mutex> lock(error_mutex);
+                error = e.what();
+            }
+        };
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> threads;
+        for (unsigned t = 0; t < opt.threads; ++t)
+            threads.emplace_back(worker);
+        for (auto &th : threads)
+            th.join();
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (failed)
+            throw runtime_error(error);
+
+        cout << "Games: " << played;
+        if (opt.adjudication.enabled())
+            cout << " (adjudicated " << adjudicated << ")";
+        cout << ", positions: " << writer.records() << " in " << writer.shards() << " shard(s) "
+             << opt.out_prefix << "-*.ckd\n";
+        cout << "Time: " << (int)sec << " sec, " << (long long)(writer.records() / max(sec, 1e-3) * 3600)
+             << " positions/hour\n";
+    }
+    catch (const exception &e)
+    {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
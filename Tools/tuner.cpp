@@ -0,0 +1,490 @@
+// Подбор весов оценки по партиям бота с самим собой (Texel-метод).
+// generate: играет партии в несколько потоков и пишет позиции с результатом партии.
+// tune: минимизирует среднеквадратичную ошибку между результатом и sigmoid(K * ln(оценка белых / оценка черных))
+// локальным поиском по весам, ошибка на всех позициях считается параллельно.
+// train-nnue: обучает нейросеть оценки (Engine/Nnue.h) на тех же данных и сохраняет ее квантованной.
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../Engine/Logic.h"
+#include "../Engine/Position.h"
+#include "../Engine/Selfplay_data.h"
+
+struct tuner_options
+{
+    string mode;
+    string data_path = "tuner_data.txt";
+    string out_path = "weights.txt";
+    string init_path;
+    int games = 1000;
+    int level = 2;
+    int random_plies = 6;
+    int max_turns = 120;
+    int iterations = 100;
+    int epochs = 10;
+    double lr = 0.01;
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    unsigned seed = unsigned(time(0));
+};
+
+// Играет партии и пишет строки "доска результат", результат с точки зрения белых: 1, 0.5 или 0
+static void generate(const tuner_options &opt)
+{
+    ofstream fout(opt.data_path);
+    mutex out_mutex;
+    atomic<int> next_game{0};
+    atomic<size_t> positions{0};
+
+    auto worker = [&]() {
+        logic_settings settings;
+        settings.no_random = true;
+        Logic8 logic(settings);
+        logic.Max_depth = opt.level;
+
+        string buffer;
+        for (int game = next_game++; game < opt.games; game = next_game++)
+        {
+            // зерно и таблица транспозиций зависят только от номера партии, а не от потока
+            mt19937 rng(opt.seed + unsigned(game));
+            logic.new_game();
+            logic.clear_cache();
+            auto mtx = start_mtx();
+            vector<string> history;
+            int turn_num = -1;
+            while (++turn_num < opt.max_turns)
+            {
+                const bool color = turn_num % 2;
+                logic.find_turns(color, mtx);
+                if (logic.turns.empty())
+                    break;
+
+                vector<move_pos> turns;
+                if (turn_num < opt.random_plies)
+                {
+                    // случайный дебют: случайный первый шаг, продолжение взятия тоже случайное
+                    turns.push_back(logic.turns[rng() % logic.turns.size()]);
+                    auto prev = mtx, next = logic.make_turn(mtx, turns.back());
+                    while (logic.continues_capture(prev, turns.back()))
+                    {
+                        logic.find_turns(turns.back().x2, turns.back().y2, next);
+                        if (!logic.have_beats)
+                            break;
+                        turns.push_back(logic.turns[rng() % logic.turns.size()]);
+                        prev = next;
+                        next = logic.make_turn(next, turns.back());
+                    }
+                }
+                else
+                {
+                    turns = logic.find_best_turns(color, mtx);
+                    history.push_back(mtx_to_string(mtx));
+                }
+                for (const auto &turn : turns)
+                    mtx = logic.make_turn(mtx, turn);
+            }
+
+            const char *result = (turn_num == opt.max_turns ? "0.5" : turn_num % 2 ? "1" : "0");
+            for (const auto &pos : history)
+                buffer += pos + " " + result + "\n";
+            positions += history.size();
+
+            if (buffer.size() > (1 << 20))
+            {
+                lock_guard<mutex> lock(out_mutex);
+                fout << buffer;
+                buffer.clear();
+            }
+        }
+        lock_guard<mutex> lock(out_mutex);
+        fout << buffer;
+    };
+
+    vector<thread> threads;
+    for (unsigned t = 0; t < opt.threads; ++t)
+        threads.emplace_back(worker);
+    for (auto &th : threads)
+        th.join();
+    cout << "Games: " << opt.games << ", positions: " << positions << " -> " << opt.data_path << "\n";
+}
+
+struct labeled_position
+{
+    eval_features w, b;
+    float result;
+};
+
+// Позиции с результатом для белых (1, 0.5 или 0): текстовый файл generate ("доска результат")
+// или шард checkers_selfplay (Engine/Selfplay_data.h)
+template <class F> static void for_each_sample(const string &path, F &&f)
+{
+    if (selfplay::is_selfplay_file(path))
+    {
+        vector<selfplay::record> records;
+        selfplay::header info;
+        if (!selfplay::load(path, records, &info))
+            return;
+        cout << path << ": " << records.size() << " positions, " << selfplay::rules_name(info.rules) << " rules\n";
+        for (const auto &rec : records)
+            f(unpack_position(rec.position()), rec.result / 2.0);
+        return;
+    }
+    ifstream fin(path);
+    string board, result;
+    while (fin >> board >> result)
+        f(mtx_from_string(board), stod(result));
+}
+
+static vector<labeled_position> load_data(const string &path)
+{
+    vector<labeled_position> res;
+    for_each_sample(path, [&](const vector<vector<POS_T>> &mtx, const double result) {
+        labeled_position pos;
+        extract_features(mtx, pos.w, pos.b);
+        // позиции без фигур одной из сторон оцениваются не весами, а специальными значениями
+        if (pos.w.men + pos.w.kings == 0 || pos.b.men + pos.b.kings == 0)
+            return;
+        pos.result = float(result);
+        res.push_back(pos);
+    });
+    return res;
+}
+
+// Среднеквадратичная ошибка предсказания результата, позиции делятся между потоками на равные куски
+static double calc_error(const vector<labeled_position> &data, const eval_weights &weights, const double k,
+                         const unsigned threads)
+{
+    vector<double> sums(threads, 0);
+    vector<thread> workers;
+    const size_t chunk = (data.size() + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            double sum = 0;
+            const size_t end = min(data.size(), (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; ++i)
+            {
+                const double w = weights.material(data[i].w), b = weights.material(data[i].b);
+                if (w <= 0 || b <= 0)
+                {
+                    sum += 1;
+                    continue;
+                }
+                const double p = 1 / (1 + exp(-k * log(w / b)));
+                sum += (data[i].result - p) * (data[i].result - p);
+            }
+            sums[t] = sum;
+        });
+    }
+    for (auto &th : workers)
+        th.join();
+    double total = 0;
+    for (double s : sums)
+        total += s;
+    return total / max<size_t>(data.size(), 1);
+}
+
+static void tune(const tuner_options &opt)
+{
+    const auto data = load_data(opt.data_path);
+    if (data.empty())
+    {
+        cout << "No positions in " << opt.data_path << "\n";
+        return;
+    }
+
+    eval_weights weights = eval_weights::preset("NumberAndPotential");
+    if (!opt.init_path.empty() && !weights.load(opt.init_path))
+    {
+        cout << "Can't load " << opt.init_path << "\n";
+        return;
+    }
+
+    // масштаб K подбирается один раз для начальных весов
+    double k = 1, best_k_error = calc_error(data, weights, k, opt.threads);
+    for (double step = 1; step > 0.001; step /= 2)
+    {
+        for (double dir : {1.0, -1.0})
+        {
+            const double error = calc_error(data, weights, k + dir * step, opt.threads);
+            if (k + dir * step > 0 && error < best_k_error)
+            {
+                best_k_error = error;
+                k += dir * step;
+            }
+        }
+    }
+    cout << "Positions: " << data.size() << ", K = " << k << ", start error = " << best_k_error << "\n";
+
+    // man фиксирован: оценка - отношение, поэтому общий масштаб весов не важен
+    const vector<string> params = {"king", "advance", "center", "back_rank"};
+    double best_error = best_k_error, step = 0.1;
+    for (int iter = 0; iter < opt.iterations && step > 1e-4; ++iter)
+    {
+        bool improved = false;
+        for (const auto &name : params)
+        {
+            for (double dir : {1.0, -1.0})
+            {
+                eval_weights candidate = weights;
+                *candidate.find(name) += dir * step * max(1.0, abs(*weights.find(name)));
+                const double error = calc_error(data, candidate, k, opt.threads);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    weights = candidate;
+                    improved = true;
+                    break;
+                }
+            }
+        }
+        if (!improved)
+            step /= 2;
+        cout << "iteration " << iter + 1 << ": error = " << best_error << ", step = " << step << "\n";
+    }
+
+    weights.save(opt.out_path);
+    cout << "Weights saved to " << opt.out_path << "\n";
+}
+
+// Нейросеть в float для обучения, та же архитектура, что и nnue_network
+struct float_network
+{
+    vector<float> w1 = vector<float>(nnue::INPUTS * nnue::L1), b1 = vector<float>(nnue::L1, 0.5f);
+    vector<float> w2 = vector<float>(nnue::L2 * nnue::L1), b2 = vector<float>(nnue::L2, 0.5f);
+    vector<float> w3 = vector<float>(nnue::L2);
+    float b3 = 0;
+
+    // Перевод в целочисленную сеть с масштабами из Nnue.h
+    void quantize(nnue_network &net) const
+    {
+        auto q = [](const double v, const double lo, const double hi) { return max(lo, min(hi, round(v))); };
+        for (int f = 0; f < nnue::INPUTS; ++f)
+            for (int k = 0; k < nnue::L1; ++k)
+                net.l1_w[f][k] = int16_t(q(w1[f * nnue::L1 + k] * nnue::ACT_SCALE, -32767, 32767));
+        for (int k = 0; k < nnue::L1; ++k)
+            net.l1_b[k] = int16_t(q(b1[k] * nnue::ACT_SCALE, -32767, 32767));
+        for (int o = 0; o < nnue::L2; ++o)
+        {
+            for (int k = 0; k < nnue::L1; ++k)
+                net.l2_w[o][k] = int8_t(q(w2[o * nnue::L1 + k] * nnue::WEIGHT_SCALE, -127, 127));
+            net.l2_b[o] = int32_t(round(b2[o] * nnue::ACT_SCALE * nnue::WEIGHT_SCALE));
+            net.out_w[o] = int8_t(q(w3[o] * nnue::WEIGHT_SCALE, -127, 127));
+        }
+        net.out_b = int32_t(round(b3 * nnue::ACT_SCALE * nnue::WEIGHT_SCALE));
+    }
+};
+
+struct nnue_sample
+{
+    vector<uint8_t> features;
+    float result;
+};
+
+static vector<nnue_sample> load_nnue_data(const string &path)
+{
+    vector<nnue_sample> res;
+    for_each_sample(path, [&](const vector<vector<POS_T>> &mtx, const double result) {
+        nnue_sample sample;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                if (mtx[i][j])
+                    sample.features.push_back(uint8_t(nnue::feature(i, j, mtx[i][j])));
+        sample.result = float(result);
+        res.push_back(sample);
+    });
+    return res;
+}
+
+// Обучение SGD с кросс-энтропией между sigmoid(выход) и результатом партии
+static void train_nnue(const tuner_options &opt)
+{
+    auto data = load_nnue_data(opt.data_path);
+    if (data.empty())
+    {
+        cout << "No positions in " << opt.data_path << "\n";
+        return;
+    }
+
+    float_network net;
+    mt19937 rng(12345);
+    uniform_real_distribution<float> init(-0.1f, 0.1f);
+    for (auto &w : net.w1)
+        w = init(rng);
+    for (auto &w : net.w2)
+        w = init(rng);
+    for (auto &w : net.w3)
+        w = init(rng);
+
+    // веса, которые квантуются в int8, держим в представимом диапазоне
+    const float w_limit = 127.0f / nnue::WEIGHT_SCALE;
+    vector<float> a1(nnue::L1), h1(nnue::L1), a2(nnue::L2), h2(nnue::L2), da1(nnue::L1), da2(nnue::L2);
+    for (int epoch = 0; epoch < opt.epochs; ++epoch)
+    {
+        shuffle(data.begin(), data.end(), rng);
+        double loss = 0;
+        const float lr = float(opt.lr);
+        for (const auto &sample : data)
+        {
+            for (int k = 0; k < nnue::L1; ++k)
+                a1[k] = net.b1[k];
+            for (uint8_t f : sample.features)
+                for (int k = 0; k < nnue::L1; ++k)
+                    a1[k] += net.w1[f * nnue::L1 + k];
+            for (int k = 0; k < nnue::L1; ++k)
+                h1[k] = min(1.0f, max(0.0f, a1[k]));
+
+            float y = net.b3;
+            for (int o = 0; o < nnue::L2; ++o)
+            {
+                a2[o] = net.b2[o];
+                for (int k = 0; k < nnue::L1; ++k)
+                    a2[o] += net.w2[o * nnue::L1 + k] * h1[k];
+                h2[o] = min(1.0f, max(0.0f, a2[o]));
+                y += net.w3[o] * h2[o];
+            }
+
+            const float p = 1 / (1 + exp(-y));
+            loss += (p - sample.result) * (p - sample.result);
+            const float dy = p - sample.result;
+
+            for (int o = 0; o < nnue::L2; ++o)
+            {
+                da2[o] = (a2[o] > 0 && a2[o] < 1) ? dy * net.w3[o] : 0;
+                net.w3[o] = max(-w_limit, min(w_limit, net.w3[o] - lr * dy * h2[o]));
+            }
+            net.b3 -= lr * dy;
+
+            for (int k = 0; k < nnue::L1; ++k)
+            {
+                float dh1 = 0;
+                for (int o = 0; o < nnue::L2; ++o)
+                    dh1 += da2[o] * net.w2[o * nnue::L1 + k];
+                da1[k] = (a1[k] > 0 && a1[k] < 1) ? dh1 : 0;
+            }
+            for (int o = 0; o < nnue::L2; ++o)
+            {
+                if (da2[o] == 0)
+                    continue;
+                for (int k = 0; k < nnue::L1; ++k)
+                {
+                    float &w = net.w2[o * nnue::L1 + k];
+                    w = max(-w_limit, min(w_limit, w - lr * da2[o] * h1[k]));
+                }
+                net.b2[o] -= lr * da2[o];
+            }
+            for (uint8_t f : sample.features)
+                for (int k = 0; k < nnue::L1; ++k)
+                    net.w1[f * nnue::L1 + k] -= lr * da1[k];
+            for (int k = 0; k < nnue::L1; ++k)
+                net.b1[k] -= lr * da1[k];
+        }
+        cout << "epoch " << epoch + 1 << ": error = " << loss / data.size() << "\n";
+    }
+
+    auto quantized = make_unique<nnue_network>();
+    net.quantize(*quantized);
+
+    // ошибка квантованной сети на тех же данных
+    double error = 0;
+    nnue_accumulator acc;
+    size_t count = 0;
+    for_each_sample(opt.data_path, [&](const vector<vector<POS_T>> &mtx, const double result) {
+        acc.refresh(*quantized, mtx);
+        const double p = 1 / (1 + exp(-acc.evaluate(*quantized)));
+        error += (p - result) * (p - result);
+        ++count;
+    });
+    cout << "Quantized error = " << error / max<size_t>(count, 1) << " (" << nnue_network::kernel_name() << ")\n";
+
+    quantized->save(opt.out_path);
+    cout << "Network saved to " << opt.out_path << "\n";
+}
+
+static bool read_args(int argc, char *argv[], tuner_options &opt)
+{
+    if (argc > 1)
+        opt.mode = argv[1];
+    if (opt.mode != "generate" && opt.mode != "tune" && opt.mode != "train-nnue")
+        return false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--data" && has_value)
+            opt.data_path = argv[++i];
+        else if (arg == "--out" && has_value)
+            opt.out_path = argv[++i];
+        else if (arg == "--init" && has_value)
+            opt.init_path = argv[++i];
+        else if (arg == "--games" && has_value)
+            opt.games = stoi(argv[++i]);
+        else if (arg == "--level" && has_value)
+            opt.level = stoi(argv[++i]);
+        else if (arg == "--random-plies" && has_value)
+            opt.random_plies = stoi(argv[++i]);
+        else if (arg == "--max-turns" && has_value)
+            opt.max_turns = stoi(argv[++i]);
+        else if (arg == "--iterations" && has_value)
+            opt.iterations = stoi(argv[++i]);
+        else if (arg == "--epochs" && has_value)
+            opt.epochs = stoi(argv[++i]);
+        else if (arg == "--lr" && has_value)
+            opt.lr = stod(argv[++i]);
+        else if (arg == "--seed" && has_value)
+            opt.seed = unsigned(stoul(argv[++i]));
+        else if (arg == "--threads" && has_value)
+            opt.threads = max(1, stoi(argv[++i]));
+        else
+            return false;
+    }
+    return true;
+}
+
+// Нечисловое или слишком большое значение (stoi, stod) - ошибка аргументов: печатается справка
+static bool parse_args(int argc, char *argv[], tuner_options &opt)
+{
+    try
+    {
+        return read_args(argc, argv, opt);
+    }
+    catch (const invalid_argument &)
+    {
+        return false;
+    }
+    catch (const out_of_range &)
+    {
+        return false;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    tuner_options opt;
+    if (!parse_args(argc, argv, opt))
+    {
+        cout << "Usage:\n"
+                "  checkers_tuner generate [--games N] [--level N] [--random-plies N] [--max-turns N]\n"
+                "                          [--seed N] [--threads N] [--data FILE]\n"
+                "  checkers_tuner tune [--data FILE] [--init WEIGHTS] [--iterations N] [--threads N] [--out WEIGHTS]\n"
+                "  checkers_tuner train-nnue [--data FILE] [--epochs N] [--lr RATE] [--out NETWORK]\n";
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    if (opt.mode == "generate")
+        generate(opt);
+    else if (opt.mode == "tune")
+        tune(opt);
+    else
+        train_nnue(opt);
+    cout << "Time: " << (int)chrono::duration<double>(chrono::steady_clock::now() - start).count() << " sec\n";
+    return 0;
+}